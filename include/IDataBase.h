@@ -32,6 +32,9 @@ public:
 
   virtual std::error_code write(IWriteBatch& batch) = 0;
   virtual std::error_code writeSync(IWriteBatch& batch) = 0;
+  // Writes the batch bypassing the write-ahead log. Data is not durable until flush() succeeds.
+  virtual std::error_code writeUnlogged(IWriteBatch& batch) = 0;
+  virtual std::error_code flush() = 0;
 
   virtual std::error_code read(IReadBatch& batch) = 0;
 };
@@ -688,6 +688,12 @@ void BlockchainCache::load() {
   serialize(s);
 }
 
+void BlockchainCache::beginBulkPush() {
+}
+
+void BlockchainCache::endBulkPush() {
+}
+
 bool BlockchainCache::isTransactionSpendTimeUnlocked(uint64_t unlockTime) const {
   return isTransactionSpendTimeUnlocked(unlockTime, getTopBlockIndex());
 }
@@ -168,6 +168,9 @@ public:
   virtual void save() override;
   virtual void load() override;
 
+  virtual void beginBulkPush() override;
+  virtual void endBulkPush() override;
+
   virtual std::vector<BinaryArray> getRawTransactions(const std::vector<Crypto::Hash> &transactions,
     std::vector<Crypto::Hash> &missedTransactions) const override;
   virtual std::vector<BinaryArray> getRawTransactions(const std::vector<Crypto::Hash> &transactions) const override;
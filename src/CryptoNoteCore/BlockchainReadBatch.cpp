@@ -74,6 +74,7 @@ BlockchainReadBatch& BlockchainReadBatch::requestKeyOutputGlobalIndexForAmount(I
 
 BlockchainReadBatch& BlockchainReadBatch::requestRawBlock(uint32_t blockIndex) {
   state.rawBlocks.emplace(blockIndex, RawBlock());
+  state.rawBlockOffsets.emplace(blockIndex, 0);
   return *this;
 }
 
@@ -145,6 +146,7 @@ std::vector<std::string> BlockchainReadBatch::getRawKeys() const {
   DB::serializeKeys(rawKeys, DB::KEY_OUTPUT_AMOUNT_PREFIX, state.keyOutputGlobalIndexesCountForAmounts);
   DB::serializeKeys(rawKeys, DB::KEY_OUTPUT_AMOUNT_PREFIX, state.keyOutputGlobalIndexesForAmounts);
   DB::serializeKeys(rawKeys, DB::BLOCK_INDEX_TO_RAW_BLOCK_PREFIX, state.rawBlocks);
+  DB::serializeKeys(rawKeys, DB::BLOCK_INDEX_TO_RAW_BLOCK_OFFSET_PREFIX, state.rawBlockOffsets);
   DB::serializeKeys(rawKeys, DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX, state.closestTimestampBlockIndex);
   DB::serializeKeys(rawKeys, DB::KEY_OUTPUT_AMOUNTS_COUNT_PREFIX, state.keyOutputAmounts);
   DB::serializeKeys(rawKeys, DB::PAYMENT_ID_TO_TX_HASH_PREFIX, state.transactionCountsByPaymentIds);
@@ -212,6 +214,10 @@ const std::unordered_map<uint32_t, RawBlock>& BlockchainReadResult::getRawBlocks
   return state.rawBlocks;
 }
 
+const std::unordered_map<uint32_t, uint64_t>& BlockchainReadResult::getRawBlockOffsets() const {
+  return state.rawBlockOffsets;
+}
+
 const std::pair<uint32_t, bool>& BlockchainReadResult::getLastBlockIndex() const {
   return state.lastBlockIndex;
 }
@@ -263,6 +269,7 @@ void BlockchainReadBatch::submitRawResult(const std::vector<std::string>& values
   DB::deserializeValues(state.keyOutputGlobalIndexesCountForAmounts, iter, DB::KEY_OUTPUT_AMOUNT_PREFIX);
   DB::deserializeValues(state.keyOutputGlobalIndexesForAmounts, iter, DB::KEY_OUTPUT_AMOUNT_PREFIX);
   DB::deserializeValues(state.rawBlocks, iter, DB::BLOCK_INDEX_TO_RAW_BLOCK_PREFIX);
+  DB::deserializeValues(state.rawBlockOffsets, iter, DB::BLOCK_INDEX_TO_RAW_BLOCK_OFFSET_PREFIX);
   DB::deserializeValues(state.closestTimestampBlockIndex, iter, DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX);
   DB::deserializeValues(state.keyOutputAmounts, iter, DB::KEY_OUTPUT_AMOUNTS_COUNT_PREFIX);
   DB::deserializeValues(state.transactionCountsByPaymentIds, iter, DB::PAYMENT_ID_TO_TX_HASH_PREFIX);
@@ -289,6 +296,7 @@ blockIndexesByBlockHashes(std::move(state.blockIndexesByBlockHashes)),
 keyOutputGlobalIndexesCountForAmounts(std::move(state.keyOutputGlobalIndexesCountForAmounts)),
 keyOutputGlobalIndexesForAmounts(std::move(state.keyOutputGlobalIndexesForAmounts)),
 rawBlocks(std::move(state.rawBlocks)),
+rawBlockOffsets(std::move(state.rawBlockOffsets)),
 blockHashesByTimestamp(std::move(state.blockHashesByTimestamp)),
 keyOutputKeys(std::move(state.keyOutputKeys)),
 closestTimestampBlockIndex(std::move(state.closestTimestampBlockIndex)),
@@ -310,6 +318,7 @@ size_t BlockchainReadState::size() const {
     keyOutputGlobalIndexesCountForAmounts.size() +
     keyOutputGlobalIndexesForAmounts.size() +
     rawBlocks.size() +
+    rawBlockOffsets.size() +
     closestTimestampBlockIndex.size() +
     keyOutputAmounts.size() +
     transactionCountsByPaymentIds.size() +
@@ -62,6 +62,7 @@ struct BlockchainReadState {
   std::unordered_map<IBlockchainCache::Amount, uint32_t> keyOutputGlobalIndexesCountForAmounts;
   std::unordered_map<std::pair<IBlockchainCache::Amount, uint32_t>, PackedOutIndex> keyOutputGlobalIndexesForAmounts;
   std::unordered_map<uint32_t, RawBlock> rawBlocks;
+  std::unordered_map<uint32_t, uint64_t> rawBlockOffsets;
   std::unordered_map<uint64_t, uint32_t> closestTimestampBlockIndex;
   std::unordered_map<uint32_t, IBlockchainCache::Amount> keyOutputAmounts;
   std::unordered_map<Crypto::Hash, uint32_t> transactionCountsByPaymentIds;
@@ -96,6 +97,7 @@ public:
   const std::unordered_map<IBlockchainCache::Amount, uint32_t>& getKeyOutputGlobalIndexesCountForAmounts() const;
   const std::unordered_map<std::pair<IBlockchainCache::Amount, uint32_t>, PackedOutIndex>& getKeyOutputGlobalIndexesForAmounts() const;
   const std::unordered_map<uint32_t, RawBlock>& getRawBlocks() const;
+  const std::unordered_map<uint32_t, uint64_t>& getRawBlockOffsets() const;
   const std::pair<uint32_t, bool>& getLastBlockIndex() const;
   const std::unordered_map<uint64_t, uint32_t>& getClosestTimestampBlockIndex() const;
   uint32_t getKeyOutputAmountsCount() const;
@@ -123,6 +125,7 @@ public:
   BlockchainReadBatch& requestBlockIndexByBlockHash(const Crypto::Hash& blockHash);
   BlockchainReadBatch& requestKeyOutputGlobalIndexesCountForAmount(IBlockchainCache::Amount amount);
   BlockchainReadBatch& requestKeyOutputGlobalIndexForAmount(IBlockchainCache::Amount amount, uint32_t outputIndexWithinAmout);
+  // Requests both the block body and its main chain storage offset, only one of them is stored for a block
   BlockchainReadBatch& requestRawBlock(uint32_t blockIndex);
   BlockchainReadBatch& requestLastBlockIndex();
   BlockchainReadBatch& requestClosestTimestampBlockIndex(uint64_t timestamp);
@@ -77,6 +77,11 @@ BlockchainWriteBatch& BlockchainWriteBatch::insertRawBlock(uint32_t blockIndex,
   return *this;
 }
 
+BlockchainWriteBatch& BlockchainWriteBatch::insertRawBlockOffset(uint32_t blockIndex, uint64_t offset) {
+  rawDataToInsert.emplace_back(DB::serialize(DB::BLOCK_INDEX_TO_RAW_BLOCK_OFFSET_PREFIX, blockIndex, offset));
+  return *this;
+}
+
 BlockchainWriteBatch& BlockchainWriteBatch::insertClosestTimestampBlockIndex(uint64_t timestamp, uint32_t blockIndex) {
   rawDataToInsert.emplace_back(DB::serialize(DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX, timestamp, blockIndex));
   return *this;
@@ -151,6 +156,11 @@ BlockchainWriteBatch& BlockchainWriteBatch::removeRawBlock(uint32_t blockIndex)
   return *this;
 }
 
+BlockchainWriteBatch& BlockchainWriteBatch::removeRawBlockOffset(uint32_t blockIndex) {
+  rawKeysToRemove.emplace_back(DB::serializeKey(DB::BLOCK_INDEX_TO_RAW_BLOCK_OFFSET_PREFIX, blockIndex));
+  return *this;
+}
+
 BlockchainWriteBatch& BlockchainWriteBatch::removeClosestTimestampBlockIndex(uint64_t timestamp) {
   rawKeysToRemove.emplace_back(DB::serializeKey(DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX, timestamp));
   return *this;
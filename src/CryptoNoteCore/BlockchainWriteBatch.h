@@ -36,6 +36,7 @@ public:
   BlockchainWriteBatch& insertCachedBlock(const CachedBlockInfo& block, uint32_t blockIndex, const std::vector<Crypto::Hash>& blockTxs);
   BlockchainWriteBatch& insertKeyOutputGlobalIndexes(IBlockchainCache::Amount amount, const std::vector<PackedOutIndex>& outputs, uint32_t totalOutputsCountForAmount);
   BlockchainWriteBatch& insertRawBlock(uint32_t blockIndex, const RawBlock& block);
+  BlockchainWriteBatch& insertRawBlockOffset(uint32_t blockIndex, uint64_t offset);
   BlockchainWriteBatch& insertClosestTimestampBlockIndex(uint64_t timestamp, uint32_t blockIndex);
   BlockchainWriteBatch& insertKeyOutputAmounts(const std::set<IBlockchainCache::Amount>& amounts, uint32_t totalKeyOutputAmountsCount);
   BlockchainWriteBatch& insertTimestamp(uint64_t timestamp, const std::vector<Crypto::Hash>& blockHashes);
@@ -47,6 +48,7 @@ public:
   BlockchainWriteBatch& removeCachedBlock(const Crypto::Hash& blockHash, uint32_t blockIndex);
   BlockchainWriteBatch& removeKeyOutputGlobalIndexes(IBlockchainCache::Amount amount, uint32_t outputsToRemoveCount, uint32_t totalOutputsCountForAmount);
   BlockchainWriteBatch& removeRawBlock(uint32_t blockIndex);
+  BlockchainWriteBatch& removeRawBlockOffset(uint32_t blockIndex);
   BlockchainWriteBatch& removeClosestTimestampBlockIndex(uint64_t timestamp);
   BlockchainWriteBatch& removeTimestamp(uint64_t timestamp);
   BlockchainWriteBatch& removeKeyOutputAmounts(uint32_t keyOutputAmountsToRemoveCount, uint32_t totalKeyOutputAmountsCount);
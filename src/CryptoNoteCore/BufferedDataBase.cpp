@@ -0,0 +1,198 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "BufferedDataBase.h"
+
+#include <cassert>
+
+namespace CryptoNote {
+
+namespace {
+
+class RawWriteBatch : public IWriteBatch {
+public:
+  std::vector<std::pair<std::string, std::string>> extractRawDataToInsert() override {
+    return std::move(rawDataToInsert);
+  }
+
+  std::vector<std::string> extractRawKeysToRemove() override {
+    return std::move(rawKeysToRemove);
+  }
+
+  std::vector<std::pair<std::string, std::string>> rawDataToInsert;
+  std::vector<std::string> rawKeysToRemove;
+};
+
+class RawReadBatch : public IReadBatch {
+public:
+  explicit RawReadBatch(std::vector<std::string>&& keys) : keys(std::move(keys)) {
+  }
+
+  std::vector<std::string> getRawKeys() const override {
+    return keys;
+  }
+
+  void submitRawResult(const std::vector<std::string>& resultValues, const std::vector<bool>& resultStates) override {
+    values = resultValues;
+    states = resultStates;
+  }
+
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  std::vector<bool> states;
+};
+
+}
+
+BufferedDataBase::BufferedDataBase(IDataBase& database) : database(database), buffering(false), bufferedSize(0) {
+}
+
+BufferedDataBase::~BufferedDataBase() {
+}
+
+void BufferedDataBase::beginBuffering() {
+  buffering = true;
+}
+
+std::error_code BufferedDataBase::flushBuffer() {
+  if (buffer.empty()) {
+    return {};
+  }
+
+  RawWriteBatch batch;
+  for (auto& entry : buffer) {
+    if (entry.second) {
+      batch.rawDataToInsert.emplace_back(entry.first, std::move(*entry.second));
+    } else {
+      batch.rawKeysToRemove.emplace_back(entry.first);
+    }
+  }
+
+  buffer.clear();
+  bufferedSize = 0;
+  return database.writeUnlogged(batch);
+}
+
+std::error_code BufferedDataBase::endBuffering() {
+  buffering = false;
+
+  auto error = flushBuffer();
+  if (error) {
+    return error;
+  }
+
+  return database.flush();
+}
+
+bool BufferedDataBase::isBuffering() const {
+  return buffering;
+}
+
+size_t BufferedDataBase::getBufferedSize() const {
+  return bufferedSize;
+}
+
+std::error_code BufferedDataBase::write(IWriteBatch& batch) {
+  if (!buffering) {
+    return database.write(batch);
+  }
+
+  bufferBatch(batch);
+  return {};
+}
+
+std::error_code BufferedDataBase::writeSync(IWriteBatch& batch) {
+  if (!buffering) {
+    return database.writeSync(batch);
+  }
+
+  bufferBatch(batch);
+  return {};
+}
+
+std::error_code BufferedDataBase::writeUnlogged(IWriteBatch& batch) {
+  if (!buffering) {
+    return database.writeUnlogged(batch);
+  }
+
+  bufferBatch(batch);
+  return {};
+}
+
+std::error_code BufferedDataBase::flush() {
+  auto error = flushBuffer();
+  if (error) {
+    return error;
+  }
+
+  return database.flush();
+}
+
+std::error_code BufferedDataBase::read(IReadBatch& batch) {
+  if (buffer.empty()) {
+    return database.read(batch);
+  }
+
+  auto keys = batch.getRawKeys();
+  std::vector<std::string> values(keys.size());
+  std::vector<bool> states(keys.size(), false);
+
+  std::vector<size_t> missedPositions;
+  std::vector<std::string> missedKeys;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto it = buffer.find(keys[i]);
+    if (it == buffer.end()) {
+      missedPositions.push_back(i);
+      missedKeys.push_back(keys[i]);
+    } else if (it->second) {
+      values[i] = *it->second;
+      states[i] = true;
+    }
+  }
+
+  if (!missedKeys.empty()) {
+    RawReadBatch missedBatch(std::move(missedKeys));
+    auto error = database.read(missedBatch);
+    if (error) {
+      return error;
+    }
+
+    assert(missedBatch.values.size() == missedPositions.size());
+    for (size_t i = 0; i < missedPositions.size(); ++i) {
+      values[missedPositions[i]] = std::move(missedBatch.values[i]);
+      states[missedPositions[i]] = missedBatch.states[i];
+    }
+  }
+
+  batch.submitRawResult(values, states);
+  return {};
+}
+
+void BufferedDataBase::bufferBatch(IWriteBatch& batch) {
+  // Removals are applied after insertions, the same way the underlying database applies a batch
+  for (auto& entry : batch.extractRawDataToInsert()) {
+    bufferedSize += entry.first.size() + entry.second.size();
+    buffer[std::move(entry.first)] = std::move(entry.second);
+  }
+
+  for (auto& key : batch.extractRawKeysToRemove()) {
+    bufferedSize += key.size();
+    buffer[std::move(key)] = boost::none;
+  }
+}
+
+}
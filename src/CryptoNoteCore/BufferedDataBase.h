@@ -0,0 +1,66 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include <boost/optional.hpp>
+
+#include "IDataBase.h"
+
+namespace CryptoNote {
+
+/*
+ * Database decorator used for bulk imports. Outside of buffering mode every call is forwarded to the
+ * underlying database. In buffering mode writes are collected in memory (reads see them) and are
+ * written to the underlying database as one large unlogged batch by flushBuffer(). They become
+ * durable only after endBuffering().
+ */
+class BufferedDataBase : public IDataBase {
+public:
+  explicit BufferedDataBase(IDataBase& database);
+  ~BufferedDataBase() override;
+
+  BufferedDataBase(const BufferedDataBase&) = delete;
+  BufferedDataBase& operator=(const BufferedDataBase&) = delete;
+
+  void beginBuffering();
+  std::error_code flushBuffer();
+  std::error_code endBuffering();
+
+  bool isBuffering() const;
+  size_t getBufferedSize() const;
+
+  std::error_code write(IWriteBatch& batch) override;
+  std::error_code writeSync(IWriteBatch& batch) override;
+  std::error_code writeUnlogged(IWriteBatch& batch) override;
+  std::error_code flush() override;
+  std::error_code read(IReadBatch& batch) override;
+
+private:
+  void bufferBatch(IWriteBatch& batch);
+
+  IDataBase& database;
+  bool buffering;
+  // boost::none marks a removed key
+  std::map<std::string, boost::optional<std::string>> buffer;
+  size_t bufferedSize;
+};
+
+}
@@ -16,8 +16,11 @@
 // along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <algorithm>
+#include <chrono>
+#include <future>
 #include <numeric>
 #include <set>
+#include <thread>
 #include <unordered_set>
 
 #include "Core.h"
@@ -149,6 +152,49 @@ TransactionValidatorState extractSpentOutputs(const std::vector<CachedTransactio
   return resultOutputs;
 }
 
+const uint32_t IMPORT_BLOCKS_CHUNK_SIZE = 256;
+
+// A main chain block read from the blockchain storage, decoded and hashed ahead of being pushed to the root segment
+struct ImportedBlock {
+  explicit ImportedBlock(RawBlock&& rawBlock) : rawBlock(std::move(rawBlock)), cumulativeSize(0), cumulativeFee(0) {
+  }
+
+  RawBlock rawBlock;
+  BlockTemplate blockTemplate;
+  std::unique_ptr<CachedBlock> cachedBlock;
+  std::vector<CachedTransaction> transactions;
+  TransactionValidatorState spentOutputs;
+  uint64_t cumulativeSize;
+  uint64_t cumulativeFee;
+  std::string error;
+};
+
+void decodeImportedBlock(const Currency& currency, ImportedBlock& block) {
+  block.blockTemplate = extractBlockTemplate(block.rawBlock);
+  block.cachedBlock.reset(new CachedBlock(block.blockTemplate));
+  block.cachedBlock->getBlockHash();
+
+  try {
+    for (const auto& rawTransaction : block.rawBlock.transactions) {
+      if (rawTransaction.size() > currency.maxTxSize()) {
+        block.error = "Raw transaction size " + std::to_string(rawTransaction.size()) + " is too big.";
+        return;
+      }
+
+      block.cumulativeSize += rawTransaction.size();
+      block.transactions.emplace_back(rawTransaction);
+      block.transactions.back().getTransactionHash();
+      block.cumulativeFee += block.transactions.back().getTransactionFee();
+    }
+  } catch (std::runtime_error& e) {
+    block.error = e.what();
+    return;
+  }
+
+  block.cumulativeSize += getObjectBinarySize(block.blockTemplate.baseTransaction);
+  block.spentOutputs = extractSpentOutputs(block.transactions);
+}
+
 int64_t getEmissionChange(const Currency& currency, IBlockchainCache& segment, uint32_t previousBlockIndex,
                           const CachedBlock& cachedBlock, uint64_t cumulativeSize, uint64_t cumulativeFee) {
 
@@ -187,6 +233,61 @@ uint32_t findCommonRoot(IMainChainStorage& storage, IBlockchainCache& rootSegmen
 }
 
 const std::chrono::seconds OUTDATED_TRANSACTION_POLLING_INTERVAL = std::chrono::seconds(60);
+const size_t BLOCK_SCAN_INFO_CACHE_SIZE = BLOCKS_SYNCHRONIZING_DEFAULT_COUNT * 10;
+
+TransactionScanInfo makeTransactionScanInfo(const Transaction& transaction, const Crypto::Hash& transactionHash,
+                                            const IBlockchainCache& segment) {
+  TransactionScanInfo scanInfo;
+  scanInfo.txHash = transactionHash;
+  scanInfo.txPublicKey = getTransactionPublicKeyFromExtra(transaction.extra);
+  scanInfo.unlockTime = transaction.unlockTime;
+
+  // global indexes are assigned to key outputs only
+  std::vector<uint32_t> globalIndexes;
+  if (!segment.getTransactionGlobalIndexes(scanInfo.txHash, globalIndexes)) {
+    throw std::runtime_error("Couldn't get global indexes of transaction " + Common::podToHex(scanInfo.txHash));
+  }
+
+  auto globalIndex = globalIndexes.begin();
+  scanInfo.outputs.reserve(transaction.outputs.size());
+  for (const auto& output : transaction.outputs) {
+    OutputScanInfo outputInfo;
+    outputInfo.amount = output.amount;
+    outputInfo.key = NULL_PUBLIC_KEY;
+    outputInfo.globalIndex = 0;
+
+    if (output.target.type() == typeid(KeyOutput)) {
+      if (globalIndex == globalIndexes.end()) {
+        throw std::runtime_error("Not enough global indexes for transaction " + Common::podToHex(scanInfo.txHash));
+      }
+
+      outputInfo.key = boost::get<KeyOutput>(output.target).key;
+      outputInfo.globalIndex = *globalIndex++;
+    }
+
+    scanInfo.outputs.push_back(outputInfo);
+  }
+
+  for (const auto& input : transaction.inputs) {
+    if (input.type() == typeid(KeyInput)) {
+      scanInfo.keyImages.push_back(boost::get<KeyInput>(input).keyImage);
+    }
+  }
+
+  return scanInfo;
+}
+
+// The block hash is passed in because it is known wherever scan infos are built
+BlockScanInfo makeBlockScanInfo(const Crypto::Hash& blockHash, const BlockTemplate& block, const IBlockchainCache& segment) {
+  BlockScanInfo scanInfo;
+  scanInfo.blockId = blockHash;
+  scanInfo.timestamp = block.timestamp;
+
+  scanInfo.transactions.reserve(block.transactionHashes.size() + 1);
+  CachedTransaction baseTransaction(block.baseTransaction);
+  scanInfo.transactions.emplace_back(makeTransactionScanInfo(baseTransaction.getTransaction(), baseTransaction.getTransactionHash(), segment));
+  return scanInfo;
+}
 
 }
 
@@ -194,7 +295,8 @@ Core::Core(const Currency& currency, Logging::ILogger& logger, Checkpoints&& che
            std::unique_ptr<IBlockchainCacheFactory>&& blockchainCacheFactory, std::unique_ptr<IMainChainStorage>&& mainchainStorage)
     : currency(currency), dispatcher(dispatcher), contextGroup(dispatcher), logger(logger, "Core"), checkpoints(std::move(checkpoints)),
       upgradeManager(new UpgradeManager()), blockchainCacheFactory(std::move(blockchainCacheFactory)),
-      mainChainStorage(std::move(mainchainStorage)), initialized(false) {
+      mainChainStorage(std::move(mainchainStorage)), initialized(false),
+      importedBlockCount(0), importBlockCount(0), importEtaSeconds(0) {
 
   upgradeManager->addMajorBlockVersion(BLOCK_MAJOR_VERSION_2, currency.upgradeHeight(BLOCK_MAJOR_VERSION_2));
   upgradeManager->addMajorBlockVersion(BLOCK_MAJOR_VERSION_3, currency.upgradeHeight(BLOCK_MAJOR_VERSION_3));
@@ -409,8 +511,48 @@ bool Core::queryBlocks(const std::vector<Crypto::Hash>& blockHashes, uint64_t ti
   }
 }
 
+bool Core::queryBlocksScan(const std::vector<Crypto::Hash>& knownBlockHashes, uint64_t timestamp, uint32_t& startIndex,
+                           uint32_t& currentIndex, uint32_t& fullOffset, std::vector<BlockScanInfo>& entries) const {
+  assert(entries.empty());
+  assert(!chainsLeaves.empty());
+  assert(!chainsStorage.empty());
+
+  throwIfNotInitialized();
+  try {
+    IBlockchainCache* mainChain = chainsLeaves[0];
+    currentIndex = mainChain->getTopBlockIndex();
+
+    startIndex = findBlockchainSupplement(knownBlockHashes); // throws
+
+    fullOffset = mainChain->getTimestampLowerBoundBlockIndex(timestamp);
+    if (fullOffset < startIndex) {
+      fullOffset = startIndex;
+    }
+
+    size_t hashesPushed = pushBlockHashes(startIndex, fullOffset, BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT, entries);
+
+    if (startIndex + static_cast<uint32_t>(hashesPushed) != fullOffset) {
+      return true;
+    }
+
+    fillQueryBlockScanInfo(fullOffset, currentIndex, BLOCKS_SYNCHRONIZING_DEFAULT_COUNT, entries);
+
+    return true;
+  } catch (std::exception& e) {
+    logger(Logging::ERROR) << "Failed to query blocks scan info: " << e.what();
+    return false;
+  }
+}
+
 bool Core::queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockHashes, uint64_t timestamp, uint32_t& startIndex,
                            uint32_t& currentIndex, uint32_t& fullOffset, std::vector<BlockShortInfo>& entries) const {
+  return queryBlocksLite(knownBlockHashes, timestamp, startIndex, currentIndex, fullOffset, entries,
+                         [](const Crypto::Hash&) { return true; });
+}
+
+bool Core::queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockHashes, uint64_t timestamp, uint32_t& startIndex,
+                           uint32_t& currentIndex, uint32_t& fullOffset, std::vector<BlockShortInfo>& entries,
+                           const std::function<bool(const Crypto::Hash&)>& needFullInfo) const {
   assert(entries.empty());
   assert(!chainsLeaves.empty());
   assert(!chainsStorage.empty());
@@ -433,7 +575,7 @@ bool Core::queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockHashes, ui
       return true;
     }
 
-    fillQueryBlockShortInfo(fullOffset, currentIndex, BLOCKS_SYNCHRONIZING_DEFAULT_COUNT, entries);
+    fillQueryBlockShortInfo(fullOffset, currentIndex, BLOCKS_SYNCHRONIZING_DEFAULT_COUNT, entries, needFullInfo);
 
     return true;
   } catch (std::exception&) {
@@ -642,6 +784,7 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
         mainChainStorage->pushBlock(rawBlock);
 
         cache->pushBlock(cachedBlock, transactions, validatorState, cumulativeBlockSize, emissionChange, currentDifficulty, std::move(rawBlock));
+        addBlockScanInfo(cachedBlock, transactions, *cache);
 
         updateBlockMedianSize();
         actualizePoolTransactionsLite(validatorState);
@@ -767,6 +910,8 @@ void Core::actualizePoolTransactionsLite(const TransactionValidatorState& valida
 void Core::switchMainChainStorage(uint32_t splitBlockIndex, IBlockchainCache& newChain) {
   assert(mainChainStorage->getBlockCount() > splitBlockIndex);
 
+  removeBlockScanInfos(splitBlockIndex);
+
   auto blocksToPop = mainChainStorage->getBlockCount() - splitBlockIndex;
   for (size_t i = 0; i < blocksToPop; ++i) {
     mainChainStorage->popBlock();
@@ -1138,10 +1283,23 @@ bool Core::getBlockTemplate(BlockTemplate& b, const AccountPublicAddress& adr, c
 }
 
 CoreStatistics Core::getCoreStatistics() const {
-  // TODO: implement it
-  assert(false);
   CoreStatistics result;
-  std::fill(reinterpret_cast<uint8_t*>(&result), reinterpret_cast<uint8_t*>(&result) + sizeof(result), 0);
+  result.transactionPoolSize = 0;
+  result.blockchainHeight = 0;
+  result.miningSpeed = 0;
+  result.alternativeBlockCount = 0;
+  result.importedBlockCount = importedBlockCount;
+  result.importBlockCount = importBlockCount;
+  result.importEtaSeconds = importEtaSeconds;
+
+  // import progress is meaningful while the core is loading, the rest only after it
+  if (initialized) {
+    result.transactionPoolSize = getPoolTransactionCount();
+    result.blockchainHeight = getTopBlockIndex() + 1;
+    result.alternativeBlockCount = getAlternativeBlockCount();
+    result.topBlockHashString = Common::podToHex(getTopBlockHash());
+  }
+
   return result;
 }
 
@@ -1548,43 +1706,103 @@ void Core::importBlocksFromStorage() {
   cutSegment(*chainsLeaves[0], commonIndex + 1);
 
   auto previousBlockHash = getBlockHash(mainChainStorage->getBlockByIndex(commonIndex));
-  auto blockCount = mainChainStorage->getBlockCount();
-  for (uint32_t i = commonIndex + 1; i < blockCount; ++i) {
-    RawBlock rawBlock = mainChainStorage->getBlockByIndex(i);
-    auto blockTemplate = extractBlockTemplate(rawBlock);
-    CachedBlock cachedBlock(blockTemplate);
+  uint32_t blockCount = mainChainStorage->getBlockCount();
+  uint32_t startIndex = commonIndex + 1;
+
+  importedBlockCount = 0;
+  importBlockCount = blockCount - startIndex;
+  importEtaSeconds = 0;
 
-    if (blockTemplate.previousBlockHash != previousBlockHash) {
-      logger(Logging::ERROR) << "Corrupted blockchain. Block with index " << i << " and hash " << cachedBlock.getBlockHash()
-                             << " has previous block hash " << blockTemplate.previousBlockHash << ", but parent has hash " << previousBlockHash
-                             << ". Resynchronize your daemon please.";
-      throw std::system_error(make_error_code(error::CoreErrorCode::CORRUPTED_BLOCKCHAIN));
+  size_t workers = std::thread::hardware_concurrency();
+  if (workers == 0) {
+    workers = 2;
+  }
+
+  // Blocks of the next chunk are decoded and hashed by the workers while the current chunk is pushed.
+  // The blocks are heap allocated, as their cached blocks refer to their block templates.
+  std::vector<std::unique_ptr<ImportedBlock>> currentBlocks;
+  std::vector<std::unique_ptr<ImportedBlock>> nextBlocks;
+  std::vector<std::future<void>> decoders;
+
+  auto startDecoding = [&](uint32_t chunkStart) {
+    uint32_t chunkEnd = std::min(chunkStart + IMPORT_BLOCKS_CHUNK_SIZE, blockCount);
+    nextBlocks.clear();
+    for (uint32_t i = chunkStart; i < chunkEnd; ++i) {
+      nextBlocks.emplace_back(new ImportedBlock(mainChainStorage->getBlockByIndex(i)));
     }
 
-    previousBlockHash = cachedBlock.getBlockHash();
+    for (size_t worker = 0; worker < workers && worker < nextBlocks.size(); ++worker) {
+      std::vector<ImportedBlock*> workerBlocks;
+      for (size_t i = worker; i < nextBlocks.size(); i += workers) {
+        workerBlocks.push_back(nextBlocks[i].get());
+      }
 
-    std::vector<CachedTransaction> transactions;
-    uint64_t cumulativeSize = 0;
-    if (!extractTransactions(rawBlock.transactions, transactions, cumulativeSize)) {
-      logger(Logging::ERROR) << "Couldn't deserialize raw block transactions in block " << cachedBlock.getBlockHash();
-      throw std::system_error(make_error_code(error::AddBlockErrorCode::DESERIALIZATION_FAILED));
+      decoders.push_back(std::async(std::launch::async, [this, workerBlocks] {
+        for (auto block : workerBlocks) {
+          decodeImportedBlock(currency, *block);
+        }
+      }));
+    }
+  };
+
+  auto importStart = std::chrono::steady_clock::now();
+  chainsLeaves[0]->beginBulkPush();
+
+  if (startIndex < blockCount) {
+    startDecoding(startIndex);
+  }
+
+  for (uint32_t chunkStart = startIndex; chunkStart < blockCount; chunkStart += IMPORT_BLOCKS_CHUNK_SIZE) {
+    for (auto& decoder : decoders) {
+      decoder.get();
+    }
+
+    decoders.clear();
+    currentBlocks.swap(nextBlocks);
+    if (blockCount - chunkStart > IMPORT_BLOCKS_CHUNK_SIZE) {
+      startDecoding(chunkStart + IMPORT_BLOCKS_CHUNK_SIZE);
     }
 
-    cumulativeSize += getObjectBinarySize(blockTemplate.baseTransaction);
-    TransactionValidatorState spentOutputs = extractSpentOutputs(transactions);
-    auto currentDifficulty = chainsLeaves[0]->getDifficultyForNextBlock(i - 1);
+    for (uint32_t i = chunkStart; i < chunkStart + currentBlocks.size(); ++i) {
+      ImportedBlock& block = *currentBlocks[i - chunkStart];
+      const CachedBlock& cachedBlock = *block.cachedBlock;
+
+      if (block.blockTemplate.previousBlockHash != previousBlockHash) {
+        logger(Logging::ERROR) << "Corrupted blockchain. Block with index " << i << " and hash " << cachedBlock.getBlockHash()
+                               << " has previous block hash " << block.blockTemplate.previousBlockHash << ", but parent has hash " << previousBlockHash
+                               << ". Resynchronize your daemon please.";
+        throw std::system_error(make_error_code(error::CoreErrorCode::CORRUPTED_BLOCKCHAIN));
+      }
 
-    uint64_t cumulativeFee = std::accumulate(transactions.begin(), transactions.end(), UINT64_C(0), [] (uint64_t fee, const CachedTransaction& transaction) {
-      return fee + transaction.getTransactionFee();
-    });
+      previousBlockHash = cachedBlock.getBlockHash();
 
-    int64_t emissionChange = getEmissionChange(currency, *chainsLeaves[0], i - 1, cachedBlock, cumulativeSize, cumulativeFee);
-    chainsLeaves[0]->pushBlock(cachedBlock, transactions, spentOutputs, cumulativeSize, emissionChange, currentDifficulty, std::move(rawBlock));
+      if (!block.error.empty()) {
+        logger(Logging::INFO) << block.error;
+        logger(Logging::ERROR) << "Couldn't deserialize raw block transactions in block " << cachedBlock.getBlockHash();
+        throw std::system_error(make_error_code(error::AddBlockErrorCode::DESERIALIZATION_FAILED));
+      }
 
-    if (i % 1000 == 0) {
-      logger(Logging::INFO) << "Imported block with index " << i << " / " << (blockCount - 1);
+      auto currentDifficulty = chainsLeaves[0]->getDifficultyForNextBlock(i - 1);
+      int64_t emissionChange = getEmissionChange(currency, *chainsLeaves[0], i - 1, cachedBlock, block.cumulativeSize, block.cumulativeFee);
+      chainsLeaves[0]->pushBlock(cachedBlock, block.transactions, block.spentOutputs, block.cumulativeSize, emissionChange, currentDifficulty, std::move(block.rawBlock));
+      currentBlocks[i - chunkStart].reset();
+
+      ++importedBlockCount;
+      if (i % 1000 == 0) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - importStart).count();
+        uint64_t blocksPerSecond = importedBlockCount * 1000 / std::max<uint64_t>(elapsed, 1);
+        importEtaSeconds = (importBlockCount - importedBlockCount) / std::max<uint64_t>(blocksPerSecond, 1);
+        logger(Logging::INFO) << "Imported block with index " << i << " / " << (blockCount - 1) << ", " << blocksPerSecond
+                              << " blocks/s, ETA " << importEtaSeconds << " s";
+      }
     }
   }
+
+  chainsLeaves[0]->endBulkPush();
+  importEtaSeconds = 0;
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - importStart).count();
+  logger(Logging::INFO) << "Imported " << importedBlockCount << " blocks in " << elapsed << " s";
 }
 
 void Core::cutSegment(IBlockchainCache& segment, uint32_t startIndex) {
@@ -1725,6 +1943,28 @@ size_t Core::pushBlockHashes(uint32_t startIndex, uint32_t fullOffset, size_t ma
   return blockIds.size();
 }
 
+size_t Core::pushBlockHashes(uint32_t startIndex, uint32_t fullOffset, size_t maxItemsCount,
+                             std::vector<BlockScanInfo>& entries) const {
+  assert(fullOffset >= startIndex);
+
+  uint32_t itemsCount = std::min(fullOffset - startIndex, static_cast<uint32_t>(maxItemsCount));
+  if (itemsCount == 0) {
+    return 0;
+  }
+
+  std::vector<Crypto::Hash> blockIds = getBlockHashes(startIndex, itemsCount);
+
+  entries.reserve(entries.size() + blockIds.size());
+  for (auto& blockHash : blockIds) {
+    BlockScanInfo entry;
+    entry.blockId = std::move(blockHash);
+    entry.timestamp = 0;
+    entries.emplace_back(std::move(entry));
+  }
+
+  return blockIds.size();
+}
+
 void Core::fillQueryBlockFullInfo(uint32_t fullOffset, uint32_t currentIndex, size_t maxItemsCount,
                                   std::vector<BlockFullInfo>& entries) const {
   assert(currentIndex >= fullOffset);
@@ -1745,7 +1985,8 @@ void Core::fillQueryBlockFullInfo(uint32_t fullOffset, uint32_t currentIndex, si
 }
 
 void Core::fillQueryBlockShortInfo(uint32_t fullOffset, uint32_t currentIndex, size_t maxItemsCount,
-                                   std::vector<BlockShortInfo>& entries) const {
+                                   std::vector<BlockShortInfo>& entries,
+                                   const std::function<bool(const Crypto::Hash&)>& needFullInfo) const {
   assert(currentIndex >= fullOffset);
 
   uint32_t fullBlocksCount = static_cast<uint32_t>(std::min(static_cast<uint32_t>(maxItemsCount), currentIndex - fullOffset + 1));
@@ -1753,11 +1994,16 @@ void Core::fillQueryBlockShortInfo(uint32_t fullOffset, uint32_t currentIndex, s
 
   for (uint32_t blockIndex = fullOffset; blockIndex < fullOffset + fullBlocksCount; ++blockIndex) {
     IBlockchainCache* segment = findMainChainSegmentContainingBlock(blockIndex);
-    RawBlock rawBlock = getRawBlock(segment, blockIndex);
 
     BlockShortInfo blockShortInfo;
-    blockShortInfo.block = std::move(rawBlock.block);
     blockShortInfo.blockId = segment->getBlockHash(blockIndex);
+    if (!needFullInfo(blockShortInfo.blockId)) {
+      entries.emplace_back(std::move(blockShortInfo));
+      continue;
+    }
+
+    RawBlock rawBlock = getRawBlock(segment, blockIndex);
+    blockShortInfo.block = std::move(rawBlock.block);
 
     blockShortInfo.txPrefixes.reserve(rawBlock.transactions.size());
     for (auto& rawTransaction : rawBlock.transactions) {
@@ -1779,6 +2025,66 @@ void Core::fillQueryBlockShortInfo(uint32_t fullOffset, uint32_t currentIndex, s
   }
 }
 
+void Core::fillQueryBlockScanInfo(uint32_t fullOffset, uint32_t currentIndex, size_t maxItemsCount,
+                                  std::vector<BlockScanInfo>& entries) const {
+  assert(currentIndex >= fullOffset);
+
+  uint32_t fullBlocksCount = static_cast<uint32_t>(std::min(static_cast<uint32_t>(maxItemsCount), currentIndex - fullOffset + 1));
+  entries.reserve(entries.size() + fullBlocksCount);
+
+  for (uint32_t blockIndex = fullOffset; blockIndex < fullOffset + fullBlocksCount; ++blockIndex) {
+    IBlockchainCache* segment = findMainChainSegmentContainingBlock(blockIndex);
+    Crypto::Hash blockHash = segment->getBlockHash(blockIndex);
+
+    auto it = blockScanInfos.find(blockIndex);
+    if (it != blockScanInfos.end() && it->second.blockId == blockHash) {
+      entries.push_back(it->second);
+      continue;
+    }
+
+    RawBlock rawBlock = getRawBlock(segment, blockIndex);
+    BlockTemplate block = extractBlockTemplate(rawBlock);
+    assert(block.transactionHashes.size() == rawBlock.transactions.size());
+
+    // hashes are taken from the stored block, only the transactions themselves are parsed
+    BlockScanInfo scanInfo = makeBlockScanInfo(blockHash, block, *segment);
+    for (size_t i = 0; i < rawBlock.transactions.size(); ++i) {
+      Transaction transaction;
+      if (!fromBinaryArray(transaction, rawBlock.transactions[i])) {
+        throw std::runtime_error("Couldn't deserialize transaction");
+      }
+
+      scanInfo.transactions.emplace_back(makeTransactionScanInfo(transaction, block.transactionHashes[i], *segment));
+    }
+
+    entries.emplace_back(std::move(scanInfo));
+  }
+}
+
+void Core::addBlockScanInfo(const CachedBlock& cachedBlock, const std::vector<CachedTransaction>& transactions,
+                            const IBlockchainCache& segment) {
+  try {
+    BlockScanInfo scanInfo = makeBlockScanInfo(cachedBlock.getBlockHash(), cachedBlock.getBlock(), segment);
+    for (const auto& transaction : transactions) {
+      scanInfo.transactions.emplace_back(makeTransactionScanInfo(transaction.getTransaction(), transaction.getTransactionHash(), segment));
+    }
+
+    blockScanInfos[cachedBlock.getBlockIndex()] = std::move(scanInfo);
+  } catch (std::exception& e) {
+    // the record is rebuilt from the stored block on request
+    logger(Logging::WARNING) << "Couldn't build scan info for block " << cachedBlock.getBlockHash() << ": " << e.what();
+    return;
+  }
+
+  while (blockScanInfos.size() > BLOCK_SCAN_INFO_CACHE_SIZE) {
+    blockScanInfos.erase(blockScanInfos.begin());
+  }
+}
+
+void Core::removeBlockScanInfos(uint32_t startBlockIndex) {
+  blockScanInfos.erase(blockScanInfos.lower_bound(startBlockIndex), blockScanInfos.end());
+}
+
 void Core::getTransactionPoolDifference(const std::vector<Crypto::Hash>& knownHashes,
                                         std::vector<Crypto::Hash>& newTransactions,
                                         std::vector<Crypto::Hash>& deletedTransactions) const {
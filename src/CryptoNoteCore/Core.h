@@ -16,6 +16,8 @@
 // along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #pragma once
+#include <functional>
+#include <map>
 #include <vector>
 #include <unordered_map>
 #include "BlockchainCache.h"
@@ -71,6 +73,12 @@ public:
     uint32_t& startIndex, uint32_t& currentIndex, uint32_t& fullOffset, std::vector<BlockFullInfo>& entries) const override;
   virtual bool queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockHashes, uint64_t timestamp,
     uint32_t& startIndex, uint32_t& currentIndex, uint32_t& fullOffset, std::vector<BlockShortInfo>& entries) const override;
+  // Full entries of blocks rejected by needFullInfo carry only the block hash, so the caller can fill them itself
+  bool queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockHashes, uint64_t timestamp,
+    uint32_t& startIndex, uint32_t& currentIndex, uint32_t& fullOffset, std::vector<BlockShortInfo>& entries,
+    const std::function<bool(const Crypto::Hash&)>& needFullInfo) const;
+  virtual bool queryBlocksScan(const std::vector<Crypto::Hash>& knownBlockHashes, uint64_t timestamp,
+    uint32_t& startIndex, uint32_t& currentIndex, uint32_t& fullOffset, std::vector<BlockScanInfo>& entries) const override;
 
   virtual bool hasTransaction(const Crypto::Hash& transactionHash) const override;
   virtual void getTransactions(const std::vector<Crypto::Hash>& transactionHashes, std::vector<BinaryArray>& transactions, std::vector<Crypto::Hash>& missedHashes) const override;
@@ -138,8 +146,16 @@ private:
   std::unique_ptr<IMainChainStorage> mainChainStorage;
   bool initialized;
 
+  // progress of the last import of blocks from mainChainStorage
+  uint32_t importedBlockCount;
+  uint32_t importBlockCount;
+  uint64_t importEtaSeconds;
+
   size_t blockMedianSize;
 
+  // scan records of the most recent main chain blocks, built when a block is pushed
+  std::map<uint32_t, BlockScanInfo> blockScanInfos;
+
   void throwIfNotInitialized() const;
   bool extractTransactions(const std::vector<BinaryArray>& rawTransactions, std::vector<CachedTransaction>& transactions, uint64_t& cumulativeSize);
 
@@ -171,9 +187,14 @@ std::error_code validateMixin(const Transaction& transaction, uint8_t majorBlock
 
   size_t pushBlockHashes(uint32_t startIndex, uint32_t fullOffset, size_t maxItemsCount, std::vector<BlockShortInfo>& entries) const;
   size_t pushBlockHashes(uint32_t startIndex, uint32_t fullOffset, size_t maxItemsCount, std::vector<BlockFullInfo>& entries) const;
+  size_t pushBlockHashes(uint32_t startIndex, uint32_t fullOffset, size_t maxItemsCount, std::vector<BlockScanInfo>& entries) const;
   bool notifyObservers(BlockchainMessage&& msg);
   void fillQueryBlockFullInfo(uint32_t fullOffset, uint32_t currentIndex, size_t maxItemsCount, std::vector<BlockFullInfo>& entries) const;
-  void fillQueryBlockShortInfo(uint32_t fullOffset, uint32_t currentIndex, size_t maxItemsCount, std::vector<BlockShortInfo>& entries) const;
+  void fillQueryBlockShortInfo(uint32_t fullOffset, uint32_t currentIndex, size_t maxItemsCount, std::vector<BlockShortInfo>& entries,
+    const std::function<bool(const Crypto::Hash&)>& needFullInfo) const;
+  void fillQueryBlockScanInfo(uint32_t fullOffset, uint32_t currentIndex, size_t maxItemsCount, std::vector<BlockScanInfo>& entries) const;
+  void addBlockScanInfo(const CachedBlock& cachedBlock, const std::vector<CachedTransaction>& transactions, const IBlockchainCache& segment);
+  void removeBlockScanInfos(uint32_t startBlockIndex);
 
   void getTransactionPoolDifference(const std::vector<Crypto::Hash>& knownHashes, std::vector<Crypto::Hash>& newTransactions, std::vector<Crypto::Hash>& deletedTransactions) const;
 
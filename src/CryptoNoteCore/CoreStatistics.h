@@ -27,6 +27,9 @@ struct CoreStatistics {
   uint64_t miningSpeed;
   uint64_t alternativeBlockCount;
   std::string topBlockHashString;
+  uint64_t importedBlockCount;
+  uint64_t importBlockCount;
+  uint64_t importEtaSeconds;
 
   void serialize(ISerializer& s) {    
     s(transactionPoolSize, "tx_pool_size");
@@ -34,6 +37,9 @@ struct CoreStatistics {
     s(miningSpeed, "mining_speed");
     s(alternativeBlockCount, "alternative_blocks");
     s(topBlockHashString, "top_block_id_str");
+    s(importedBlockCount, "imported_blocks");
+    s(importBlockCount, "blocks_to_import");
+    s(importEtaSeconds, "import_eta_seconds");
   }
 };
 
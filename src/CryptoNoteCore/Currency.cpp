@@ -816,6 +816,7 @@ logger(currency.logger) {
 
 CurrencyBuilder::CurrencyBuilder(Logging::ILogger& log) : m_currency(log) {
   cryptonoteName(CRYPTONOTE_NAME);
+  genesisCoinbaseTxHex(parameters::GENESIS_COINBASE_TX_HEX);
   maxBlockNumber(parameters::CRYPTONOTE_MAX_BLOCK_NUMBER);
   maxBlockBlobSize(parameters::CRYPTONOTE_MAX_BLOCK_BLOB_SIZE);
   maxTxSize(parameters::CRYPTONOTE_MAX_TX_SIZE);
@@ -842,6 +843,8 @@ zawyDifficultyV2(parameters::ZAWY_DIFFICULTY_V2);
 zawyDifficultyBlockVersion(parameters::ZAWY_DIFFICULTY_DIFFICULTY_BLOCK_VERSION);
 buggedZawyDifficultyBlockIndex(parameters::BUGGED_ZAWY_DIFFICULTY_BLOCK_INDEX);
   blockGrantedFullRewardZone(parameters::CRYPTONOTE_BLOCK_GRANTED_FULL_REWARD_ZONE);
+  blockGrantedFullRewardZoneV1(parameters::CRYPTONOTE_BLOCK_GRANTED_FULL_REWARD_ZONE_V1);
+  blockGrantedFullRewardZoneV2(parameters::CRYPTONOTE_BLOCK_GRANTED_FULL_REWARD_ZONE_V2);
   minerTxBlobReservedSize(parameters::CRYPTONOTE_COINBASE_BLOB_RESERVED_SIZE);
 maxTransactionSizeLimit(parameters::MAX_TRANSACTION_SIZE_LIMIT);
 
@@ -854,6 +857,12 @@ maxTransactionSizeLimit(parameters::MAX_TRANSACTION_SIZE_LIMIT);
   difficultyWindow(parameters::DIFFICULTY_WINDOW);
   difficultyLag(parameters::DIFFICULTY_LAG);
   difficultyCut(parameters::DIFFICULTY_CUT);
+  difficultyWindowV1(parameters::DIFFICULTY_WINDOW_V1);
+  difficultyWindowV2(parameters::DIFFICULTY_WINDOW_V2);
+  difficultyLagV1(parameters::DIFFICULTY_LAG_V1);
+  difficultyLagV2(parameters::DIFFICULTY_LAG_V2);
+  difficultyCutV1(parameters::DIFFICULTY_CUT_V1);
+  difficultyCutV2(parameters::DIFFICULTY_CUT_V2);
 
   maxBlockSizeInitial(parameters::MAX_BLOCK_SIZE_INITIAL);
   maxBlockSizeGrowthSpeedNumerator(parameters::MAX_BLOCK_SIZE_GROWTH_SPEED_NUMERATOR);
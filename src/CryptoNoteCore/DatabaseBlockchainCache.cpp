@@ -39,6 +39,8 @@ namespace {
 
 const uint32_t ONE_DAY_SECONDS = 60 * 60 * 24;
 const CachedBlockInfo NULL_CACHED_BLOCK_INFO {NULL_HASH, 0, 0, 0, 0, 0};
+const uint32_t BULK_PUSH_FLUSH_BLOCK_COUNT = 500;
+const size_t BULK_PUSH_FLUSH_SIZE = 64 * 1024 * 1024;
 
 bool requestPackedOutputs(IBlockchainCache::Amount amount, Common::ArrayView<uint32_t> globalIndexes, IDataBase& database, std::vector<PackedOutIndex>& result) {
   BlockchainReadBatch readBatch;
@@ -192,7 +194,32 @@ std::pair<boost::optional<uint32_t>, bool> requestClosestBlockIndexByTimestamp(u
   return result;
 }
 
-bool requestRawBlock(IDataBase& database, uint32_t blockIndex, RawBlock& block) {
+bool extractRawBlock(const BlockchainReadResult& result, const IMainChainStorage* rawBlockStorage, uint32_t blockIndex, RawBlock& block) {
+  auto blockIt = result.getRawBlocks().find(blockIndex);
+  if (blockIt != result.getRawBlocks().end()) {
+    block = blockIt->second;
+    return true;
+  }
+
+  auto offsetIt = result.getRawBlockOffsets().find(blockIndex);
+  if (offsetIt == result.getRawBlockOffsets().end() || rawBlockStorage == nullptr) {
+    return false;
+  }
+
+  block = rawBlockStorage->getBlockByOffset(offsetIt->second);
+  return true;
+}
+
+RawBlock extractRawBlock(const BlockchainReadResult& result, const IMainChainStorage* rawBlockStorage, uint32_t blockIndex) {
+  RawBlock block;
+  if (!extractRawBlock(result, rawBlockStorage, blockIndex, block)) {
+    throw std::out_of_range("Raw block " + std::to_string(blockIndex) + " not found");
+  }
+
+  return block;
+}
+
+bool requestRawBlock(IDataBase& database, const IMainChainStorage* rawBlockStorage, uint32_t blockIndex, RawBlock& block) {
   auto batch = BlockchainReadBatch().requestRawBlock(blockIndex);
 
   auto error = database.read(batch);
@@ -202,12 +229,7 @@ bool requestRawBlock(IDataBase& database, uint32_t blockIndex, RawBlock& block)
   }
 
   auto result = batch.extractResult();
-  if (result.getRawBlocks().count(blockIndex) == 0) {
-    return false;
-  }
-
-  block = result.getRawBlocks().at(blockIndex);
-  return true;
+  return extractRawBlock(result, rawBlockStorage, blockIndex, block);
 }
 
 Transaction extractTransaction(const RawBlock& block, uint32_t transactionIndex) {
@@ -243,7 +265,7 @@ size_t requestPaymentIdTransactionsCount(IDataBase& database, const Crypto::Hash
   return result.getTransactionCountByPaymentIds().at(paymentId);
 }
 
-bool requestPaymentId(IDataBase& database, const Crypto::Hash& transactionHash, Crypto::Hash& paymentId) {
+bool requestPaymentId(IDataBase& database, const IMainChainStorage* rawBlockStorage, const Crypto::Hash& transactionHash, Crypto::Hash& paymentId) {
   std::vector<CachedTransactionInfo> cachedTransactions;
 
   if (!requestCachedTransactionInfos({transactionHash}, database, cachedTransactions)) {
@@ -255,7 +277,7 @@ bool requestPaymentId(IDataBase& database, const Crypto::Hash& transactionHash,
   }
 
   RawBlock block;
-  if (!requestRawBlock(database, cachedTransactions[0].blockIndex, block)) {
+  if (!requestRawBlock(database, rawBlockStorage, cachedTransactions[0].blockIndex, block)) {
     return false;
   }
 
@@ -299,6 +321,10 @@ public:
     ++globalOutputIndex;
   }
 
+  void decrement() {
+    --globalOutputIndex;
+  }
+
   void advance(difference_type n) {
     assert(n >= -static_cast<difference_type>(globalOutputIndex));
     globalOutputIndex += static_cast<uint32_t>(n);
@@ -428,8 +454,9 @@ struct DatabaseBlockchainCache::ExtendedPushedBlockInfo {
 };
 
 
-DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency& curr, IDataBase& dataBase, IBlockchainCacheFactory& blockchainCacheFactory, Logging::ILogger& _logger)
-    : currency(curr), database(dataBase), blockchainCacheFactory(blockchainCacheFactory), logger(_logger, "DatabaseBlockchainCache") {
+DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency& curr, IDataBase& dataBase, IBlockchainCacheFactory& blockchainCacheFactory, Logging::ILogger& _logger,
+                                                 const IMainChainStorage* rawBlockStorage)
+    : currency(curr), bufferedDatabase(dataBase), database(bufferedDatabase), bulkPushedBlocks(0), blockchainCacheFactory(blockchainCacheFactory), rawBlockStorage(rawBlockStorage), logger(_logger, "DatabaseBlockchainCache") {
   DatabaseVersionReadBatch readBatch;
   auto ec = database.read(readBatch);
   if (ec) {
@@ -479,6 +506,54 @@ bool DatabaseBlockchainCache::checkDBSchemeVersion(IDataBase& database, Logging:
   }
 }
 
+bool DatabaseBlockchainCache::checkRawBlockStorage(IDataBase& database, const IMainChainStorage& rawBlockStorage, Logging::ILogger& _logger) {
+  Logging::LoggerRef logger(_logger, "DatabaseBlockchainCache");
+
+  BlockchainReadBatch lastBlockIndexBatch;
+  lastBlockIndexBatch.requestLastBlockIndex();
+  auto ec = database.read(lastBlockIndexBatch);
+  if (ec) {
+    throw std::system_error(ec);
+  }
+
+  auto lastBlockIndex = lastBlockIndexBatch.extractResult().getLastBlockIndex();
+  if (!lastBlockIndex.second) {
+    return true;
+  }
+
+  uint32_t topIndex = lastBlockIndex.first;
+  auto batch = BlockchainReadBatch().requestRawBlock(topIndex).requestCachedBlock(topIndex);
+  ec = database.read(batch);
+  if (ec) {
+    throw std::system_error(ec);
+  }
+
+  auto result = batch.extractResult();
+  auto offsetIt = result.getRawBlockOffsets().find(topIndex);
+  if (offsetIt == result.getRawBlockOffsets().end()) {
+    // Block body is kept in the database itself
+    return true;
+  }
+
+  // Blocks are referenced in order and the storage is append-only, so a valid top block means valid references below it
+  bool consistent = false;
+  if (topIndex < rawBlockStorage.getBlockCount() && rawBlockStorage.getBlockOffset(topIndex) == offsetIt->second &&
+      result.getCachedBlocks().count(topIndex) != 0) {
+    try {
+      BlockTemplate block = fromBinaryArray<BlockTemplate>(rawBlockStorage.getBlockByOffset(offsetIt->second).block);
+      consistent = CachedBlock(block).getBlockHash() == result.getCachedBlocks().at(topIndex).blockHash;
+    } catch (std::exception&) {
+    }
+  }
+
+  if (!consistent) {
+    logger(Logging::WARNING) << "DB top block " << topIndex << " is missing in blocks storage, which has " << rawBlockStorage.getBlockCount()
+                             << " blocks. DB will be destroyed and recreated from blocks storage.";
+  }
+
+  return consistent;
+}
+
 void DatabaseBlockchainCache::deleteClosestTimestampBlockIndex(BlockchainWriteBatch& writeBatch, uint32_t splitBlockIndex) {
   auto batch = BlockchainReadBatch().requestCachedBlock(splitBlockIndex);
   auto blockResult = readDatabase(batch);
@@ -540,7 +615,7 @@ std::unique_ptr<IBlockchainCache> DatabaseBlockchainCache::split(uint32_t splitB
     auto& validatorState = std::get<2>(*it);
     uint64_t timestamp = std::get<3>(*it);
 
-    writeBatch.removeCachedBlock(blockHash, blockIndex).removeRawBlock(blockIndex);
+    writeBatch.removeCachedBlock(blockHash, blockIndex).removeRawBlock(blockIndex).removeRawBlockOffset(blockIndex);
     requestDeleteSpentOutputs(writeBatch,
                               blockIndex,
                               validatorState);
@@ -646,7 +721,7 @@ void DatabaseBlockchainCache::requestDeletePaymentIds(BlockchainWriteBatch& writ
 
   for (const auto& hash: transactionHashes) {
     Crypto::Hash paymentId;
-    if (!requestPaymentId(database, hash, paymentId)) {
+    if (!requestPaymentId(database, rawBlockStorage, hash, paymentId)) {
       continue;
     }
 
@@ -897,7 +972,7 @@ void DatabaseBlockchainCache::pushBlock(const CachedBlock& cachedBlock,
   txHashes.insert(txHashes.begin(), cachedBaseTransaction.getTransactionHash());
 
   batch.insertCachedBlock(blockInfo, getTopBlockIndex() + 1, txHashes);
-  batch.insertRawBlock(getTopBlockIndex() + 1, std::move(rawBlock));
+  insertRawBlock(batch, getTopBlockIndex() + 1, std::move(rawBlock));
 
   auto transactionIndex = 0;
   pushTransaction(cachedBaseTransaction, getTopBlockIndex() + 1, transactionIndex++, batch);
@@ -924,6 +999,15 @@ void DatabaseBlockchainCache::pushBlock(const CachedBlock& cachedBlock,
     throw std::runtime_error(res.message());
   }
 
+  if (bufferedDatabase.isBuffering() && (++bulkPushedBlocks >= BULK_PUSH_FLUSH_BLOCK_COUNT || bufferedDatabase.getBufferedSize() >= BULK_PUSH_FLUSH_SIZE)) {
+    bulkPushedBlocks = 0;
+    res = bufferedDatabase.flushBuffer();
+    if (res) {
+      logger(Logging::ERROR) << "push block " << cachedBlock.getBlockHash() << " bulk write failed: " << res.message();
+      throw std::runtime_error(res.message());
+    }
+  }
+
   topBlockIndex = *topBlockIndex + 1;
   topBlockHash = cachedBlock.getBlockHash();
   logger(Logging::DEBUGGING) << "push block " << cachedBlock.getBlockHash() << " completed";
@@ -1405,6 +1489,19 @@ void DatabaseBlockchainCache::save() {
 void DatabaseBlockchainCache::load() {
 }
 
+void DatabaseBlockchainCache::beginBulkPush() {
+  bulkPushedBlocks = 0;
+  bufferedDatabase.beginBuffering();
+}
+
+void DatabaseBlockchainCache::endBulkPush() {
+  auto error = bufferedDatabase.endBuffering();
+  if (error) {
+    logger(Logging::ERROR) << "bulk push failed: failed to write to database, " << error.message();
+    throw std::runtime_error(error.message());
+  }
+}
+
 std::vector<BinaryArray>
 DatabaseBlockchainCache::getRawTransactions(const std::vector<Crypto::Hash>& transactions,
                                             std::vector<Crypto::Hash>& missedTransactions) const {
@@ -1436,9 +1533,16 @@ void DatabaseBlockchainCache::getRawTransactions(const std::vector<Crypto::Hash>
 
   auto blocks = readDatabase(batch);
 
+  std::unordered_map<uint32_t, RawBlock> blocksMap;
+  for (auto& tx : res.getCachedTransactions()) {
+    RawBlock block;
+    if (blocksMap.count(tx.second.blockIndex) == 0 && extractRawBlock(blocks, rawBlockStorage, tx.second.blockIndex, block)) {
+      blocksMap.emplace(tx.second.blockIndex, std::move(block));
+    }
+  }
+
   foundTransactions.reserve(foundTransactions.size() + transactions.size());
   auto& hashesMap = res.getCachedTransactions();
-  auto& blocksMap = blocks.getRawBlocks();
   for (const auto& hash: transactions) {
     auto transactionIt = hashesMap.find(hash);
     if (transactionIt == hashesMap.end()) {
@@ -1467,7 +1571,7 @@ void DatabaseBlockchainCache::getRawTransactions(const std::vector<Crypto::Hash>
 RawBlock DatabaseBlockchainCache::getBlockByIndex(uint32_t index) const {
   auto batch = BlockchainReadBatch().requestRawBlock(index);
   auto res = readDatabase(batch);
-  return std::move(res.getRawBlocks().at(index));
+  return extractRawBlock(res, rawBlockStorage, index);
 }
 
 BinaryArray DatabaseBlockchainCache::getRawTransaction(uint32_t blockIndex, uint32_t transactionIndex) const {
@@ -1652,7 +1756,7 @@ DatabaseBlockchainCache::ExtendedPushedBlockInfo DatabaseBlockchainCache::getExt
 
   ExtendedPushedBlockInfo extendedInfo;
 
-  extendedInfo.pushedBlockInfo.rawBlock = dbResult.getRawBlocks().at(blockIndex);
+  extendedInfo.pushedBlockInfo.rawBlock = extractRawBlock(dbResult, rawBlockStorage, blockIndex);
   extendedInfo.pushedBlockInfo.blockSize = blockInfo.blockSize;
   extendedInfo.pushedBlockInfo.blockDifficulty = blockInfo.cumulativeDifficulty - previousBlockInfo.cumulativeDifficulty;
   extendedInfo.pushedBlockInfo.generatedCoins = blockInfo.alreadyGeneratedCoins - previousBlockInfo.alreadyGeneratedCoins;
@@ -1693,6 +1797,16 @@ BlockchainReadResult DatabaseBlockchainCache::readDatabase(BlockchainReadBatch&
   return batch.extractResult();
 }
 
+void DatabaseBlockchainCache::insertRawBlock(BlockchainWriteBatch& batch, uint32_t blockIndex, RawBlock&& rawBlock) const {
+  // Main chain blocks reach the storage before the database, so there is normally nothing to copy
+  if (rawBlockStorage != nullptr && blockIndex < rawBlockStorage->getBlockCount()) {
+    assert(rawBlockStorage->getBlockByIndex(blockIndex).block == rawBlock.block);
+    batch.insertRawBlockOffset(blockIndex, rawBlockStorage->getBlockOffset(blockIndex));
+  } else {
+    batch.insertRawBlock(blockIndex, std::move(rawBlock));
+  }
+}
+
 void DatabaseBlockchainCache::addGenesisBlock(CachedBlock&& genesisBlock) {
   uint64_t minerReward = 0;
   for (const TransactionOutput& output : genesisBlock.getBlock().baseTransaction.outputs) {
@@ -1715,7 +1829,7 @@ void DatabaseBlockchainCache::addGenesisBlock(CachedBlock&& genesisBlock) {
   pushTransaction(cachedBaseTransaction, 0, 0, batch);
 
   batch.insertCachedBlock(blockInfo, 0, {cachedBaseTransaction.getTransactionHash()});
-  batch.insertRawBlock(0, {toBinaryArray(genesisBlock.getBlock()), {}});
+  insertRawBlock(batch, 0, {toBinaryArray(genesisBlock.getBlock()), {}});
   batch.insertClosestTimestampBlockIndex(roundToMidnight(genesisBlock.getBlock().timestamp), 0);
 
   auto res = database.write(batch);
@@ -23,10 +23,12 @@
 #include "IBlockchainCache.h"
 #include "CryptoNoteCore/UpgradeManager.h"
 #include <IDataBase.h>
+#include <CryptoNoteCore/BufferedDataBase.h>
 #include <CryptoNoteCore/BlockchainReadBatch.h>
 #include <CryptoNoteCore/BlockchainWriteBatch.h>
 #include <CryptoNoteCore/DatabaseCacheData.h>
 #include <CryptoNoteCore/IBlockchainCacheFactory.h>
+#include <CryptoNoteCore/IMainChainStorage.h>
 
 namespace CryptoNote {
 
@@ -45,12 +47,22 @@ public:
   /*
    * Constructs new DatabaseBlockchainCache object. Currnetly, only factories that produce 
    * BlockchainCache objects as children are supported.
+   * If rawBlockStorage is set, block bodies already kept there are not copied to the database,
+   * only their offsets in rawBlockStorage are stored.
    */
   DatabaseBlockchainCache(const Currency& currency, IDataBase& dataBase,
-                          IBlockchainCacheFactory& blockchainCacheFactory, Logging::ILogger& logger);
+                          IBlockchainCacheFactory& blockchainCacheFactory, Logging::ILogger& logger,
+                          const IMainChainStorage* rawBlockStorage = nullptr);
 
   static bool checkDBSchemeVersion(IDataBase& dataBase, Logging::ILogger& logger);
 
+  /*
+   * Checks that the top database block can be read from rawBlockStorage. The storage is append-only
+   * and group-committed, so after a crash it may have lost blocks the database still refers to.
+   * Returns false if the database has to be rebuilt from rawBlockStorage.
+   */
+  static bool checkRawBlockStorage(IDataBase& dataBase, const IMainChainStorage& rawBlockStorage, Logging::ILogger& logger);
+
   /*
    * This methods splits cache, upper part (ie blocks with indexes larger than splitBlockIndex)
    * is copied to new BlockchainCache. Unfortunately, implementation requires return value to be of
@@ -140,6 +152,9 @@ public:
   virtual void save() override;
   virtual void load() override;
 
+  virtual void beginBulkPush() override;
+  virtual void endBulkPush() override;
+
   virtual std::vector<BinaryArray> getRawTransactions(const std::vector<Crypto::Hash>& transactions,
                                                       std::vector<Crypto::Hash>& missedTransactions) const override;
   virtual std::vector<BinaryArray> getRawTransactions(const std::vector<Crypto::Hash>& transactions) const override;
@@ -161,8 +176,11 @@ public:
 
 private:
   const Currency& currency;
+  BufferedDataBase bufferedDatabase;
   IDataBase& database;
+  uint32_t bulkPushedBlocks;
   IBlockchainCacheFactory& blockchainCacheFactory;
+  const IMainChainStorage* rawBlockStorage;
   mutable boost::optional<uint32_t> topBlockIndex;
   mutable boost::optional<Crypto::Hash> topBlockHash;
   mutable boost::optional<uint64_t> transactionsCount;
@@ -179,6 +197,7 @@ private:
   void deleteClosestTimestampBlockIndex(BlockchainWriteBatch& writeBatch, uint32_t splitBlockIndex);
   CachedBlockInfo getCachedBlockInfo(uint32_t index) const;
   BlockchainReadResult readDatabase(BlockchainReadBatch& batch) const;
+  void insertRawBlock(BlockchainWriteBatch& batch, uint32_t blockIndex, RawBlock&& rawBlock) const;
 
   void addSpentKeyImage(const Crypto::KeyImage& keyImage, uint32_t blockIndex);
   void pushTransaction(const CachedTransaction& cachedTransaction,
@@ -24,7 +24,8 @@
 
 namespace CryptoNote {
 
-DatabaseBlockchainCacheFactory::DatabaseBlockchainCacheFactory(IDataBase& database, Logging::ILogger& logger): database(database), logger(logger) {
+DatabaseBlockchainCacheFactory::DatabaseBlockchainCacheFactory(IDataBase& database, Logging::ILogger& logger, const IMainChainStorage* rawBlockStorage):
+  database(database), logger(logger), rawBlockStorage(rawBlockStorage) {
 
 }
 
@@ -33,7 +34,7 @@ DatabaseBlockchainCacheFactory::~DatabaseBlockchainCacheFactory() {
 }
 
 std::unique_ptr<IBlockchainCache> DatabaseBlockchainCacheFactory::createRootBlockchainCache(const Currency& currency) {
-  return std::unique_ptr<IBlockchainCache> (new DatabaseBlockchainCache(currency, database, *this, logger));
+  return std::unique_ptr<IBlockchainCache> (new DatabaseBlockchainCache(currency, database, *this, logger, rawBlockStorage));
 }
 
 std::unique_ptr<IBlockchainCache> DatabaseBlockchainCacheFactory::createBlockchainCache(const Currency& currency, IBlockchainCache* parent, uint32_t startIndex) {
@@ -23,10 +23,11 @@
 namespace CryptoNote {
 
 class IDataBase;
+class IMainChainStorage;
 
 class DatabaseBlockchainCacheFactory: public IBlockchainCacheFactory {
 public:
-  explicit DatabaseBlockchainCacheFactory(IDataBase& database, Logging::ILogger& logger);
+  explicit DatabaseBlockchainCacheFactory(IDataBase& database, Logging::ILogger& logger, const IMainChainStorage* rawBlockStorage = nullptr);
   virtual ~DatabaseBlockchainCacheFactory();
 
   virtual std::unique_ptr<IBlockchainCache> createRootBlockchainCache(const Currency& currency) override;
@@ -35,6 +36,7 @@ public:
 private:
   IDataBase& database;
   Logging::ILogger& logger;
+  const IMainChainStorage* rawBlockStorage;
 };
 
 } //namespace CryptoNote
@@ -171,6 +171,10 @@ public:
   virtual void save() = 0;
   virtual void load() = 0;
 
+  // Lets the cache group writes of many pushed blocks, they are guaranteed to be durable only after endBulkPush()
+  virtual void beginBulkPush() = 0;
+  virtual void endBulkPush() = 0;
+
   virtual std::vector<uint64_t> getLastUnits(size_t count, uint32_t blockIndex, UseGenesis use,
                                              std::function<uint64_t(const CachedBlockInfo&)> pred) const = 0;
   virtual std::vector<Crypto::Hash> getTransactionHashes() const = 0;
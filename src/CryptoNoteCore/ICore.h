@@ -65,6 +65,9 @@ public:
   virtual bool queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockHashes, uint64_t timestamp,
                                uint32_t& startIndex, uint32_t& currentIndex, uint32_t& fullOffset,
                                std::vector<BlockShortInfo>& entries) const = 0;
+  virtual bool queryBlocksScan(const std::vector<Crypto::Hash>& knownBlockHashes, uint64_t timestamp,
+                               uint32_t& startIndex, uint32_t& currentIndex, uint32_t& fullOffset,
+                               std::vector<BlockScanInfo>& entries) const = 0;
 
   virtual bool hasTransaction(const Crypto::Hash& transactionHash) const = 0;
   virtual void getTransactions(const std::vector<Crypto::Hash>& transactionHashes,
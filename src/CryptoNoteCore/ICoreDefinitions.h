@@ -39,8 +39,33 @@ struct BlockShortInfo {
   std::vector<TransactionPrefixInfo> txPrefixes;
 };
 
+struct OutputScanInfo {
+  uint64_t amount;
+  Crypto::PublicKey key;
+  uint32_t globalIndex;
+};
+
+// Only the parts of a transaction a wallet needs to find its outputs and spends
+struct TransactionScanInfo {
+  Crypto::Hash txHash;
+  Crypto::PublicKey txPublicKey;
+  uint64_t unlockTime;
+  std::vector<OutputScanInfo> outputs;
+  std::vector<Crypto::KeyImage> keyImages;
+};
+
+// transactions are empty for entries that carry only the block hash, otherwise the first one is coinbase
+struct BlockScanInfo {
+  Crypto::Hash blockId;
+  uint64_t timestamp;
+  std::vector<TransactionScanInfo> transactions;
+};
+
 void serialize(BlockFullInfo&, ISerializer&);
 void serialize(TransactionPrefixInfo&, ISerializer&);
 void serialize(BlockShortInfo&, ISerializer&);
+void serialize(OutputScanInfo&, ISerializer&);
+void serialize(TransactionScanInfo&, ISerializer&);
+void serialize(BlockScanInfo&, ISerializer&);
 
 }
@@ -31,6 +31,10 @@ public:
   virtual RawBlock getBlockByIndex(uint32_t index) const = 0;
   virtual uint32_t getBlockCount() const = 0;
 
+  // Offsets are stable while the block stays in the storage and let the DB refer to a block body without copying it
+  virtual uint64_t getBlockOffset(uint32_t index) const = 0;
+  virtual RawBlock getBlockByOffset(uint64_t offset) const = 0;
+
   virtual void clear() = 0;
 };
 
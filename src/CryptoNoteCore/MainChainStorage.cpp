@@ -17,60 +17,373 @@
 
 #include "MainChainStorage.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include <boost/filesystem.hpp>
 
+#include "Common/MemoryInputStream.h"
+#include "crypto/hash.h"
+#include "Serialization/BinaryInputStreamSerializer.h"
+
 #include "CryptoNoteTools.h"
+#include "SwappedVector.h"
 
 namespace CryptoNote {
 
-const size_t STORAGE_CACHE_SIZE = 100;
+namespace {
+
+const uint32_t RECORD_MAGIC = 0x6b6c6231;
+const uint64_t INDEX_VERSION = 1;
+const size_t SEGMENT_NUMBER_WIDTH = 6;
+const char INDEX_FILENAME_SUFFIX[] = ".offsets";
+const size_t LEGACY_STORAGE_CACHE_SIZE = 100;
+
+uint64_t getChecksum(const uint8_t* data, size_t size) {
+  Crypto::Hash hash = Crypto::cn_fast_hash(data, size);
+  uint64_t checksum;
+  std::memcpy(&checksum, &hash, sizeof(checksum));
+  return checksum;
+}
+
+void importLegacyStorage(MainChainStorage& storage, const std::string& blocksFilename, const std::string& indexesFilename) {
+  {
+    SwappedVector<RawBlock> legacyStorage;
+    if (!legacyStorage.open(blocksFilename, indexesFilename, LEGACY_STORAGE_CACHE_SIZE)) {
+      throw std::runtime_error("Failed to load legacy main chain storage: " + blocksFilename);
+    }
+
+    for (uint64_t i = 0; i < legacyStorage.size(); ++i) {
+      storage.pushBlock(legacyStorage[i]);
+    }
+
+    storage.commit();
+    legacyStorage.close();
+  }
+
+  boost::filesystem::remove(blocksFilename);
+  boost::filesystem::remove(indexesFilename);
+}
+
+}
+
+const uint64_t MainChainStorage::DEFAULT_SEGMENT_SIZE;
+const uint32_t MainChainStorage::DEFAULT_COMMIT_INTERVAL;
+
+MainChainStorage::MainChainStorage(const std::string& blocksFilename, const std::string& indexesFilename, uint64_t segmentSize, uint32_t commitInterval) :
+  blocksFilename(blocksFilename), segmentSize(segmentSize), commitInterval(commitInterval), uncommittedCount(0), writeOffset(0), syncedOffset(0) {
 
-MainChainStorage::MainChainStorage(const std::string& blocksFilename, const std::string& indexesFilename) {
-  if (!storage.open(blocksFilename, indexesFilename, STORAGE_CACHE_SIZE)) {
-    throw std::runtime_error("Failed to load main chain storage: " + blocksFilename);
+  offsets.setAutoFlush(false);
+  offsets.open(indexesFilename, Common::FileMappedVectorOpenMode::OPEN_OR_CREATE, sizeof(IndexPrefix));
+
+  IndexPrefix prefix;
+  std::memcpy(&prefix, offsets.prefix(), sizeof(prefix));
+  if (prefix.version == 0) {
+    prefix.version = INDEX_VERSION;
+    prefix.segmentSize = segmentSize;
+    prefix.committedCount = 0;
+    std::memcpy(offsets.prefix(), &prefix, sizeof(prefix));
+    offsets.clear();
+    offsets.flush();
+  } else if (prefix.version != INDEX_VERSION || prefix.segmentSize == 0) {
+    throw std::runtime_error("Failed to load main chain storage: unsupported index format " + indexesFilename);
   }
+
+  this->segmentSize = prefix.segmentSize;
+
+  if (!offsets.empty()) {
+    size_t lastSegment = static_cast<size_t>(offsets.back() / this->segmentSize);
+    segments.resize(lastSegment + 1);
+    for (size_t i = 0; i <= lastSegment; ++i) {
+      if (boost::filesystem::exists(getSegmentFilename(i))) {
+        segments[i].reset(new System::MemoryMappedFile());
+        segments[i]->open(getSegmentFilename(i));
+      }
+    }
+  }
+
+  recoverTail(std::min(prefix.committedCount, offsets.size()));
 }
 
 MainChainStorage::~MainChainStorage() {
-  storage.close();
+  try {
+    commit();
+  } catch (std::exception&) {
+  }
+
+  closeSegments();
 }
 
 void MainChainStorage::pushBlock(const RawBlock& rawBlock) {
-  storage.push_back(rawBlock);
+  BinaryArray data = toBinaryArray(rawBlock);
+  uint64_t recordSize = sizeof(RecordHeader) + data.size();
+  if (recordSize > segmentSize) {
+    throw std::runtime_error("Block of size " + std::to_string(data.size()) + " doesn't fit main chain storage segment of size " + std::to_string(segmentSize));
+  }
+
+  uint64_t segmentOffset = writeOffset % segmentSize;
+  if (segmentOffset + recordSize > segmentSize) {
+    writeOffset += segmentSize - segmentOffset;
+    segmentOffset = 0;
+  }
+
+  System::MemoryMappedFile& segment = getSegment(static_cast<size_t>(writeOffset / segmentSize));
+
+  RecordHeader header;
+  header.magic = RECORD_MAGIC;
+  header.size = static_cast<uint32_t>(data.size());
+  header.checksum = getChecksum(data.data(), data.size());
+  std::memcpy(segment.data() + segmentOffset, &header, sizeof(header));
+  std::memcpy(segment.data() + segmentOffset + sizeof(header), data.data(), data.size());
+
+  offsets.push_back(writeOffset);
+  writeOffset += recordSize;
+
+  if (++uncommittedCount >= commitInterval) {
+    commit();
+  }
 }
 
 void MainChainStorage::popBlock() {
-  storage.pop_back();
+  assert(!offsets.empty());
+
+  offsets.pop_back();
+
+  if (offsets.empty()) {
+    writeOffset = 0;
+  } else {
+    RecordHeader header;
+    const uint8_t* data;
+    if (!readRecord(offsets.back(), header, data)) {
+      throw std::runtime_error("Main chain storage is corrupted at block index " + std::to_string(offsets.size() - 1));
+    }
+
+    writeOffset = offsets.back() + sizeof(header) + header.size;
+  }
+
+  syncedOffset = std::min(syncedOffset, writeOffset);
+  if (uncommittedCount > 0) {
+    --uncommittedCount;
+  }
+
+  // The popped record will be overwritten by the next push, so it must drop out of the committed range first
+  IndexPrefix prefix;
+  std::memcpy(&prefix, offsets.prefix(), sizeof(prefix));
+  if (prefix.committedCount > offsets.size()) {
+    writeCommittedCount(offsets.size());
+  }
 }
 
 RawBlock MainChainStorage::getBlockByIndex(uint32_t index) const {
-  if (index >= storage.size()) {
-    throw std::out_of_range("Block index " + std::to_string(index) + " is out of range. Blocks count: " + std::to_string(storage.size()));
+  Common::ArrayView<uint8_t> view = getRawBlockView(index);
+  return deserializeBlock(view.getData(), view.getSize());
+}
+
+uint32_t MainChainStorage::getBlockCount() const {
+  return static_cast<uint32_t>(offsets.size());
+}
+
+uint64_t MainChainStorage::getBlockOffset(uint32_t index) const {
+  if (index >= offsets.size()) {
+    throw std::out_of_range("Block index " + std::to_string(index) + " is out of range. Blocks count: " + std::to_string(offsets.size()));
   }
 
-  return storage[index];
+  return offsets[index];
 }
 
-uint32_t MainChainStorage::getBlockCount() const {
-  return static_cast<uint32_t>(storage.size());
+RawBlock MainChainStorage::getBlockByOffset(uint64_t offset) const {
+  RecordHeader header;
+  const uint8_t* data;
+  if (offset >= writeOffset || !readRecord(offset, header, data)) {
+    throw std::out_of_range("There is no block at main chain storage offset " + std::to_string(offset));
+  }
+
+  return deserializeBlock(data, header.size);
 }
 
 void MainChainStorage::clear() {
-  storage.clear();
+  offsets.clear();
+  writeOffset = 0;
+  syncedOffset = 0;
+  uncommittedCount = 0;
+  writeCommittedCount(0);
+
+  closeSegments();
+  for (size_t i = 0; boost::filesystem::exists(getSegmentFilename(i)); ++i) {
+    boost::filesystem::remove(getSegmentFilename(i));
+  }
+}
+
+Common::ArrayView<uint8_t> MainChainStorage::getRawBlockView(uint32_t index) const {
+  if (index >= offsets.size()) {
+    throw std::out_of_range("Block index " + std::to_string(index) + " is out of range. Blocks count: " + std::to_string(offsets.size()));
+  }
+
+  RecordHeader header;
+  const uint8_t* data;
+  if (!readRecord(offsets[index], header, data)) {
+    throw std::runtime_error("Main chain storage is corrupted at block index " + std::to_string(index));
+  }
+
+  return Common::ArrayView<uint8_t>(data, header.size);
+}
+
+void MainChainStorage::commit() {
+  IndexPrefix prefix;
+  std::memcpy(&prefix, offsets.prefix(), sizeof(prefix));
+  if (uncommittedCount == 0 && prefix.committedCount == offsets.size()) {
+    return;
+  }
+
+  syncData();
+  writeCommittedCount(offsets.size());
+  uncommittedCount = 0;
+}
+
+std::string MainChainStorage::getSegmentFilename(size_t segmentIndex) const {
+  std::string number = std::to_string(segmentIndex);
+  if (number.size() < SEGMENT_NUMBER_WIDTH) {
+    number.insert(0, SEGMENT_NUMBER_WIDTH - number.size(), '0');
+  }
+
+  return blocksFilename + "." + number;
+}
+
+System::MemoryMappedFile& MainChainStorage::getSegment(size_t segmentIndex) {
+  if (segmentIndex >= segments.size()) {
+    segments.resize(segmentIndex + 1);
+  }
+
+  if (!segments[segmentIndex]) {
+    std::unique_ptr<System::MemoryMappedFile> segment(new System::MemoryMappedFile());
+    std::string filename = getSegmentFilename(segmentIndex);
+    if (boost::filesystem::exists(filename) && boost::filesystem::file_size(filename) == segmentSize) {
+      segment->open(filename);
+    } else {
+      segment->create(filename, segmentSize, true);
+    }
+
+    segments[segmentIndex] = std::move(segment);
+  }
+
+  return *segments[segmentIndex];
+}
+
+bool MainChainStorage::readRecord(uint64_t offset, RecordHeader& header, const uint8_t*& data) const {
+  size_t segmentIndex = static_cast<size_t>(offset / segmentSize);
+  uint64_t segmentOffset = offset % segmentSize;
+  if (segmentIndex >= segments.size() || !segments[segmentIndex]) {
+    return false;
+  }
+
+  const System::MemoryMappedFile& segment = *segments[segmentIndex];
+  if (segmentOffset + sizeof(header) > segment.size()) {
+    return false;
+  }
+
+  std::memcpy(&header, segment.data() + segmentOffset, sizeof(header));
+  if (header.magic != RECORD_MAGIC || header.size > segment.size() - segmentOffset - sizeof(header)) {
+    return false;
+  }
+
+  data = segment.data() + segmentOffset + sizeof(header);
+  return true;
+}
+
+RawBlock MainChainStorage::deserializeBlock(const uint8_t* data, size_t size) const {
+  RawBlock rawBlock;
+  Common::MemoryInputStream stream(data, size);
+  BinaryInputStreamSerializer serializer(stream);
+  serialize(rawBlock, serializer);
+  return rawBlock;
+}
+
+void MainChainStorage::recoverTail(uint64_t committedCount) {
+  uint64_t blockCount = committedCount;
+  uint64_t recordEnd = 0;
+
+  if (committedCount > 0) {
+    RecordHeader header;
+    const uint8_t* data;
+    if (!readRecord(offsets[committedCount - 1], header, data)) {
+      throw std::runtime_error("Main chain storage is corrupted at block index " + std::to_string(committedCount - 1));
+    }
+
+    recordEnd = offsets[committedCount - 1] + sizeof(header) + header.size;
+  }
+
+  // Anything past the last commit may be torn: the index could have reached the disk before the data it points to
+  for (; blockCount < offsets.size(); ++blockCount) {
+    RecordHeader header;
+    const uint8_t* data;
+    if (offsets[blockCount] < recordEnd || !readRecord(offsets[blockCount], header, data) || header.checksum != getChecksum(data, header.size)) {
+      break;
+    }
+
+    recordEnd = offsets[blockCount] + sizeof(header) + header.size;
+  }
+
+  while (offsets.size() > blockCount) {
+    offsets.pop_back();
+  }
+
+  writeOffset = recordEnd;
+  syncedOffset = recordEnd;
+  writeCommittedCount(offsets.size());
+}
+
+void MainChainStorage::syncData() {
+  while (syncedOffset < writeOffset) {
+    size_t segmentIndex = static_cast<size_t>(syncedOffset / segmentSize);
+    uint64_t segmentOffset = syncedOffset % segmentSize;
+    uint64_t size = std::min(writeOffset - syncedOffset, segmentSize - segmentOffset);
+
+    if (segmentIndex < segments.size() && segments[segmentIndex]) {
+      segments[segmentIndex]->flush(segments[segmentIndex]->data() + segmentOffset, size);
+    }
+
+    syncedOffset += size;
+  }
+}
+
+void MainChainStorage::writeCommittedCount(uint64_t committedCount) {
+  offsets.flush();
+
+  IndexPrefix prefix;
+  std::memcpy(&prefix, offsets.prefix(), sizeof(prefix));
+  prefix.committedCount = committedCount;
+  std::memcpy(offsets.prefix(), &prefix, sizeof(prefix));
+  offsets.flush();
 }
 
-std::unique_ptr<IMainChainStorage> createSwappedMainChainStorage(const std::string& dataDir, const Currency& currency) {
+void MainChainStorage::closeSegments() {
+  for (auto& segment : segments) {
+    if (segment) {
+      std::error_code ignore;
+      segment->close(ignore);
+    }
+  }
+
+  segments.clear();
+}
+
+std::unique_ptr<IMainChainStorage> createMainChainStorage(const std::string& dataDir, const Currency& currency) {
   boost::filesystem::path blocksFilename = boost::filesystem::path(dataDir) / currency.blocksFileName();
   boost::filesystem::path indexesFilename = boost::filesystem::path(dataDir) / currency.blockIndexesFileName();
 
-  std::unique_ptr<IMainChainStorage> storage(new MainChainStorage(blocksFilename.string(), indexesFilename.string()));
+  std::unique_ptr<MainChainStorage> storage(new MainChainStorage(blocksFilename.string(), indexesFilename.string() + INDEX_FILENAME_SUFFIX));
+  if (storage->getBlockCount() == 0 && boost::filesystem::exists(blocksFilename) && boost::filesystem::exists(indexesFilename)) {
+    importLegacyStorage(*storage, blocksFilename.string(), indexesFilename.string());
+  }
+
   if (storage->getBlockCount() == 0) {
     RawBlock genesis;
     genesis.block = toBinaryArray(currency.genesisBlock());
     storage->pushBlock(genesis);
+    storage->commit();
   }
 
-  return storage;
+  return std::move(storage);
 }
 
 }
@@ -17,15 +17,32 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
+#include "Common/ArrayView.h"
+#include "Common/FileMappedVector.h"
+#include "System/MemoryMappedFile.h"
+
 #include "IMainChainStorage.h"
 #include "Currency.h"
-#include "SwappedVector.h"
 
 namespace CryptoNote {
 
+// Append-only main chain block store.
+//
+// Serialized raw blocks are appended to fixed-size memory mapped segment files (<blocksFilename>.000000,
+// <blocksFilename>.000001, ...). A file mapped vector of fixed-width offsets maps a block index to the record
+// holding the block. Writes are group-committed: data and index are synced every commitInterval blocks, on
+// popBlock, clear and on destruction. Blocks appended after the last commit are verified when the store is
+// opened and the index is cut at the first torn record.
 class MainChainStorage: public IMainChainStorage {
 public:
-  MainChainStorage(const std::string& blocksFilame, const std::string& indexesFilename);
+  static const uint64_t DEFAULT_SEGMENT_SIZE = 256 * 1024 * 1024;
+  static const uint32_t DEFAULT_COMMIT_INTERVAL = 128;
+
+  MainChainStorage(const std::string& blocksFilename, const std::string& indexesFilename,
+    uint64_t segmentSize = DEFAULT_SEGMENT_SIZE, uint32_t commitInterval = DEFAULT_COMMIT_INTERVAL);
   virtual ~MainChainStorage();
 
   virtual void pushBlock(const RawBlock& rawBlock) override;
@@ -34,12 +51,50 @@ public:
   virtual RawBlock getBlockByIndex(uint32_t index) const override;
   virtual uint32_t getBlockCount() const override;
 
+  virtual uint64_t getBlockOffset(uint32_t index) const override;
+  virtual RawBlock getBlockByOffset(uint64_t offset) const override;
+
   virtual void clear() override;
 
+  // Returns serialized RawBlock bytes straight from the mapped segment. The view stays valid until the block is
+  // popped, the storage is cleared or destroyed.
+  Common::ArrayView<uint8_t> getRawBlockView(uint32_t index) const;
+
+  // Syncs all appended blocks to disk.
+  void commit();
+
 private:
-  mutable SwappedVector<RawBlock> storage;
+  struct RecordHeader {
+    uint32_t magic;
+    uint32_t size;
+    uint64_t checksum;
+  };
+
+  struct IndexPrefix {
+    uint64_t version;
+    uint64_t segmentSize;
+    uint64_t committedCount;
+  };
+
+  std::string blocksFilename;
+  uint64_t segmentSize;
+  uint32_t commitInterval;
+  uint32_t uncommittedCount;
+  uint64_t writeOffset;
+  uint64_t syncedOffset;
+  Common::FileMappedVector<uint64_t> offsets;
+  std::vector<std::unique_ptr<System::MemoryMappedFile>> segments;
+
+  std::string getSegmentFilename(size_t segmentIndex) const;
+  System::MemoryMappedFile& getSegment(size_t segmentIndex);
+  bool readRecord(uint64_t offset, RecordHeader& header, const uint8_t*& data) const;
+  RawBlock deserializeBlock(const uint8_t* data, size_t size) const;
+  void recoverTail(uint64_t committedCount);
+  void syncData();
+  void writeCommittedCount(uint64_t committedCount);
+  void closeSegments();
 };
 
-std::unique_ptr<IMainChainStorage> createSwappedMainChainStorage(const std::string& dataDir, const Currency& currency);
+std::unique_ptr<IMainChainStorage> createMainChainStorage(const std::string& dataDir, const Currency& currency);
 
 }
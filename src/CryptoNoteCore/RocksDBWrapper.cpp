@@ -112,7 +112,7 @@ std::error_code RocksDBWrapper::write(IWriteBatch& batch) {
     throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::NOT_INITIALIZED));
   }
 
-  return write(batch, false);
+  return write(batch, rocksdb::WriteOptions());
 }
 
 std::error_code RocksDBWrapper::writeSync(IWriteBatch& batch) {
@@ -120,13 +120,41 @@ std::error_code RocksDBWrapper::writeSync(IWriteBatch& batch) {
     throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::NOT_INITIALIZED));
   }
 
-  return write(batch, true);
+  rocksdb::WriteOptions writeOptions;
+  writeOptions.sync = true;
+  return write(batch, writeOptions);
 }
 
-std::error_code RocksDBWrapper::write(IWriteBatch& batch, bool sync) {
+std::error_code RocksDBWrapper::writeUnlogged(IWriteBatch& batch) {
+  if (state.load() != INITIALIZED) {
+    throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::NOT_INITIALIZED));
+  }
+
   rocksdb::WriteOptions writeOptions;
-  writeOptions.sync = sync;
+  writeOptions.disableWAL = true;
+  return write(batch, writeOptions);
+}
+
+std::error_code RocksDBWrapper::flush() {
+  if (state.load() != INITIALIZED) {
+    throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::NOT_INITIALIZED));
+  }
+
+  // Unlogged writes live only in memtables, so they have to be flushed to table files to survive a crash
+  rocksdb::Status status = db->Flush(rocksdb::FlushOptions());
+  if (status.ok()) {
+    status = db->SyncWAL();
+  }
+
+  if (!status.ok()) {
+    logger(ERROR) << "Can't flush DB. " << status.ToString();
+    return make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR);
+  }
+
+  return std::error_code();
+}
 
+std::error_code RocksDBWrapper::write(IWriteBatch& batch, const rocksdb::WriteOptions& writeOptions) {
   rocksdb::WriteBatch rocksdbBatch;
   std::vector<std::pair<std::string, std::string>> rawData(batch.extractRawDataToInsert());
   for (const std::pair<std::string, std::string>& kvPair : rawData) {
@@ -47,10 +47,12 @@ public:
 
   std::error_code write(IWriteBatch& batch) override;
   std::error_code writeSync(IWriteBatch& batch) override;
+  std::error_code writeUnlogged(IWriteBatch& batch) override;
+  std::error_code flush() override;
   std::error_code read(IReadBatch& batch) override;
 
 private:
-  std::error_code write(IWriteBatch& batch, bool sync);
+  std::error_code write(IWriteBatch& batch, const rocksdb::WriteOptions& writeOptions);
 
   rocksdb::Options getDBOptions(const DataBaseConfig& config);
   std::string getDataDir(const DataBaseConfig& config);
@@ -589,7 +589,9 @@ for (const auto& cp : checkpoint_input) {
     database.init(dbConfig);
     Tools::ScopeExit dbShutdownOnExit([&database] () { database.shutdown(); });
 
-    if (!DatabaseBlockchainCache::checkDBSchemeVersion(database, logManager))
+    std::unique_ptr<IMainChainStorage> mainChainStorage = createMainChainStorage(data_dir_path.string(), currency);
+    if (!DatabaseBlockchainCache::checkDBSchemeVersion(database, logManager) ||
+        !DatabaseBlockchainCache::checkRawBlockStorage(database, *mainChainStorage, logManager))
     {
       dbShutdownOnExit.cancel();
       database.shutdown();
@@ -607,8 +609,8 @@ for (const auto& cp : checkpoint_input) {
       logManager,
       std::move(checkpoints),
       dispatcher,
-      std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(database, logger.getLogger())),
-      createSwappedMainChainStorage(data_dir_path.string(), currency));
+      std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(database, logger.getLogger(), mainChainStorage.get())),
+      std::move(mainChainStorage));
 
     ccore.load();
     logger(INFO) << "Core initialized OK";
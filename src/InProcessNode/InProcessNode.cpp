@@ -714,6 +714,35 @@ std::error_code InProcessNode::doQueryBlocksLite(std::vector<Crypto::Hash>&& kno
   return std::error_code();
 }
 
+void InProcessNode::queryBlocksScan(std::vector<Crypto::Hash>&& knownBlockIds, uint64_t timestamp,
+                                    std::vector<BlockScanInfo>& newBlocks, uint32_t& startHeight,
+                                    const Callback& callback) {
+  auto lock = std::unique_lock<std::mutex>{mutex};
+  if (state != INITIALIZED) {
+    lock.unlock();
+    callback(make_error_code(CryptoNote::error::NOT_INITIALIZED));
+    return;
+  }
+
+  executeInDispatcherThread([=, &newBlocks, &startHeight] () mutable {
+    auto ec = doQueryBlocksScan(std::move(knownBlockIds), timestamp, newBlocks, startHeight);
+    executeInRemoteThread([callback, ec] () { callback(ec); });
+  });
+}
+
+std::error_code InProcessNode::doQueryBlocksScan(std::vector<Crypto::Hash>&& knownBlockIds, uint64_t timestamp,
+                                                 std::vector<BlockScanInfo>& newBlocks, uint32_t& startHeight) {
+  uint32_t currentHeight, fullOffset;
+  std::vector<CryptoNote::BlockScanInfo> entries;
+
+  if (!core.queryBlocksScan(knownBlockIds, timestamp, startHeight, currentHeight, fullOffset, entries)) {
+    return make_error_code(CryptoNote::error::INTERNAL_NODE_ERROR);
+  }
+
+  newBlocks.insert(newBlocks.end(), std::make_move_iterator(entries.begin()), std::make_move_iterator(entries.end()));
+  return std::error_code();
+}
+
 void InProcessNode::getPoolSymmetricDifference(std::vector<Crypto::Hash>&& knownPoolTxIds, Crypto::Hash knownBlockId,
                                                bool& isBcActual,
                                                std::vector<std::unique_ptr<ITransactionReader>>& newTxs,
@@ -29,10 +29,8 @@
 namespace CryptoNote {
 class HttpResponse;
 class HttpRequest;
-}
-
-namespace Common {
-class JsonValue;
+class JsonInputBufferSerializer;
+class JsonOutputBufferSerializer;
 }
 
 namespace System {
@@ -49,14 +47,13 @@ public:
   void start(const std::string& bindAddress, uint16_t bindPort);
 
 protected:
-  static void makeErrorResponse(const std::error_code& ec, Common::JsonValue& resp);
-  static void makeMethodNotFoundResponse(Common::JsonValue& resp);
-  static void makeGenericErrorReponse(Common::JsonValue& resp, const char* what, int errorCode = -32001);
-  static void fillJsonResponse(const Common::JsonValue& v, Common::JsonValue& resp);
-  static void prepareJsonResponse(const Common::JsonValue& req, Common::JsonValue& resp);
-  static void makeJsonParsingErrorResponse(Common::JsonValue& resp);
+  static void makeErrorResponse(const std::error_code& ec, JsonOutputBufferSerializer& resp);
+  static void makeMethodNotFoundResponse(JsonOutputBufferSerializer& resp);
+  static void makeGenericErrorReponse(JsonOutputBufferSerializer& resp, const char* what, int errorCode = -32001);
+  static void prepareJsonResponse(JsonInputBufferSerializer& req, JsonOutputBufferSerializer& resp);
+  static void makeJsonParsingErrorResponse(JsonOutputBufferSerializer& resp);
 
-  virtual void processJsonRpcRequest(const Common::JsonValue& req, Common::JsonValue& resp) = 0;
+  virtual void processJsonRpcRequest(JsonInputBufferSerializer& req, JsonOutputBufferSerializer& resp) = 0;
 
 private:
   // HttpServer
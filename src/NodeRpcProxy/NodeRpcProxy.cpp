@@ -442,6 +442,18 @@ void NodeRpcProxy::queryBlocks(std::vector<Crypto::Hash>&& knownBlockIds, uint64
           std::ref(newBlocks), std::ref(startHeight)), callback);
 }
 
+void NodeRpcProxy::queryBlocksScan(std::vector<Crypto::Hash>&& knownBlockIds, uint64_t timestamp, std::vector<BlockScanInfo>& newBlocks,
+  uint32_t& startHeight, const Callback& callback) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_state != STATE_INITIALIZED) {
+    callback(make_error_code(error::NOT_INITIALIZED));
+    return;
+  }
+
+  scheduleRequest(std::bind(&NodeRpcProxy::doQueryBlocksScan, this, std::move(knownBlockIds), timestamp,
+          std::ref(newBlocks), std::ref(startHeight)), callback);
+}
+
 void NodeRpcProxy::getPoolSymmetricDifference(std::vector<Crypto::Hash>&& knownPoolTxIds, Crypto::Hash knownBlockId, bool& isBcActual,
         std::vector<std::unique_ptr<ITransactionReader>>& newTxs, std::vector<Crypto::Hash>& deletedTxIds, const Callback& callback) {
   std::lock_guard<std::mutex> lock(m_mutex);
@@ -615,6 +627,28 @@ std::error_code NodeRpcProxy::doQueryBlocksLite(const std::vector<Crypto::Hash>&
   return std::error_code();
 }
 
+std::error_code NodeRpcProxy::doQueryBlocksScan(const std::vector<Crypto::Hash>& knownBlockIds, uint64_t timestamp,
+        std::vector<CryptoNote::BlockScanInfo>& newBlocks, uint32_t& startHeight) {
+  CryptoNote::COMMAND_RPC_QUERY_BLOCKS_SCAN::request req = AUTO_VAL_INIT(req);
+  CryptoNote::COMMAND_RPC_QUERY_BLOCKS_SCAN::response rsp = AUTO_VAL_INIT(rsp);
+
+  req.blockIds = knownBlockIds;
+  req.timestamp = timestamp;
+
+  m_logger(TRACE) << "Send queryblocksscan.bin request, timestamp " << req.timestamp;
+  std::error_code ec = binaryCommand("/queryblocksscan.bin", req, rsp);
+  if (ec) {
+    m_logger(TRACE) << "queryblocksscan.bin failed: " << ec << ", " << ec.message();
+    return ec;
+  }
+
+  m_logger(TRACE) << "queryblocksscan.bin compete, startHeight " << rsp.startHeight << ", block count " << rsp.items.size();
+  startHeight = static_cast<uint32_t>(rsp.startHeight);
+  newBlocks = std::move(rsp.items);
+
+  return std::error_code();
+}
+
 std::error_code NodeRpcProxy::doGetPoolSymmetricDifference(std::vector<Crypto::Hash>&& knownPoolTxIds, Crypto::Hash knownBlockId, bool& isBcActual,
         std::vector<std::unique_ptr<ITransactionReader>>& newTxs, std::vector<Crypto::Hash>& deletedTxIds) {
   CryptoNote::COMMAND_RPC_GET_POOL_CHANGES_LITE::request req = AUTO_VAL_INIT(req);
@@ -83,8 +83,7 @@ public:
   template <typename T>
   static bool decode(const BinaryArray& buf, T& value) {
     try {
-      Common::MemoryInputStream stream(buf.data(), buf.size());
-      KVBinaryInputStreamSerializer serializer(stream);
+      KVBinaryInputStreamSerializer serializer(Common::StringView(reinterpret_cast<const char*>(buf.data()), buf.size()));
       serialize(value, serializer);
     } catch (std::exception&) {
       return false;
@@ -65,6 +65,12 @@ public:
     callback(std::error_code());
   };
 
+  virtual void queryBlocksScan(std::vector<Crypto::Hash>&& knownBlockIds, uint64_t timestamp, std::vector<CryptoNote::BlockScanInfo>& newBlocks,
+    uint32_t& startHeight, const Callback& callback) override {
+    startHeight = 0;
+    callback(std::error_code());
+  };
+
   virtual void getPoolSymmetricDifference(std::vector<Crypto::Hash>&& knownPoolTxIds, Crypto::Hash knownBlockId, bool& isBcActual,
           std::vector<std::unique_ptr<CryptoNote::ITransactionReader>>& newTxs, std::vector<Crypto::Hash>& deletedTxIds, const Callback& callback) override {
     isBcActual = true;
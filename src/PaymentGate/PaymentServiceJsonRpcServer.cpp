@@ -22,8 +22,6 @@
 #include "PaymentServiceJsonRpcMessages.h"
 #include "WalletService.h"
 
-#include "Serialization/JsonInputValueSerializer.h"
-#include "Serialization/JsonOutputStreamSerializer.h"
 
 namespace PaymentService {
 
@@ -58,24 +56,23 @@ PaymentServiceJsonRpcServer::PaymentServiceJsonRpcServer(System::Dispatcher& sys
   handlers.emplace("estimateFusion", jsonHandler<EstimateFusion::Request, EstimateFusion::Response>(std::bind(&PaymentServiceJsonRpcServer::handleEstimateFusion, this, std::placeholders::_1, std::placeholders::_2)));
 }
 
-void PaymentServiceJsonRpcServer::processJsonRpcRequest(const Common::JsonValue& req, Common::JsonValue& resp) {
+void PaymentServiceJsonRpcServer::processJsonRpcRequest(CryptoNote::JsonInputBufferSerializer& req, CryptoNote::JsonOutputBufferSerializer& resp) {
   try {
     prepareJsonResponse(req, resp);
 
-    if (!req.contains("method")) {
-      logger(Logging::WARNING) << "Field \"method\" is not found in json request: " << req;
-      makeGenericErrorReponse(resp, "Invalid Request", -3600);
-      return;
-    }
-
-    if (!req("method").isString()) {
+    std::string method;
+    try {
+      if (!req(method, "method")) {
+        logger(Logging::WARNING) << "Field \"method\" is not found in json request: " << req;
+        makeGenericErrorReponse(resp, "Invalid Request", -3600);
+        return;
+      }
+    } catch (std::runtime_error&) {
       logger(Logging::WARNING) << "Field \"method\" is not a string type: " << req;
       makeGenericErrorReponse(resp, "Invalid Request", -3600);
       return;
     }
 
-    std::string method = req("method").getString();
-
     auto it = handlers.find(method);
     if (it == handlers.end()) {
       logger(Logging::WARNING) << "Requested method not found: " << method;
@@ -85,12 +82,7 @@ void PaymentServiceJsonRpcServer::processJsonRpcRequest(const Common::JsonValue&
 
     logger(Logging::DEBUGGING) << method << " request came";
 
-    Common::JsonValue params(Common::JsonValue::OBJECT);
-    if (req.contains("params")) {
-      params = req("params");
-    }
-
-    it->second(params, resp);
+    it->second(req, resp);
   } catch (std::exception& e) {
     logger(Logging::WARNING) << "Error occurred while processing JsonRpc request: " << e.what();
     makeGenericErrorReponse(resp, e.what());
@@ -19,11 +19,10 @@
 
 #include <unordered_map>
 
-#include "Common/JsonValue.h"
 #include "JsonRpcServer/JsonRpcServer.h"
 #include "PaymentServiceJsonRpcMessages.h"
-#include "Serialization/JsonInputValueSerializer.h"
-#include "Serialization/JsonOutputStreamSerializer.h"
+#include "Serialization/JsonInputBufferSerializer.h"
+#include "Serialization/JsonOutputBufferSerializer.h"
 
 namespace PaymentService {
 
@@ -35,23 +34,25 @@ public:
   PaymentServiceJsonRpcServer(const PaymentServiceJsonRpcServer&) = delete;
 
 protected:
-  virtual void processJsonRpcRequest(const Common::JsonValue& req, Common::JsonValue& resp) override;
+  virtual void processJsonRpcRequest(CryptoNote::JsonInputBufferSerializer& req, CryptoNote::JsonOutputBufferSerializer& resp) override;
 
 private:
   WalletService& service;
   Logging::LoggerRef logger;
 
-  typedef std::function<void (const Common::JsonValue& jsonRpcParams, Common::JsonValue& jsonResponse)> HandlerFunction;
+  typedef std::function<void (CryptoNote::JsonInputBufferSerializer& jsonRpcRequest, CryptoNote::JsonOutputBufferSerializer& jsonResponse)> HandlerFunction;
 
   template <typename RequestType, typename ResponseType, typename RequestHandler>
   HandlerFunction jsonHandler(RequestHandler handler) {
-    return [handler] (const Common::JsonValue& jsonRpcParams, Common::JsonValue& jsonResponse) mutable {
+    return [handler] (CryptoNote::JsonInputBufferSerializer& jsonRpcRequest, CryptoNote::JsonOutputBufferSerializer& jsonResponse) mutable {
       RequestType request;
       ResponseType response;
 
       try {
-        CryptoNote::JsonInputValueSerializer inputSerializer(const_cast<Common::JsonValue&>(jsonRpcParams));
-        serialize(request, inputSerializer);
+        if (!jsonRpcRequest(request, "params")) {
+          CryptoNote::JsonInputBufferSerializer emptyParams(Common::StringView("{}"));
+          serialize(request, emptyParams);
+        }
       } catch (std::exception&) {
         makeGenericErrorReponse(jsonResponse, "Invalid Request", -32600);
         return;
@@ -63,9 +64,7 @@ private:
         return;
       }
 
-      CryptoNote::JsonOutputStreamSerializer outputSerializer;
-      serialize(response, outputSerializer);
-      fillJsonResponse(outputSerializer.getValue(), jsonResponse);
+      jsonResponse(response, "result");
     };
   }
 
@@ -268,7 +268,11 @@ dbConfig.setDataDir(data_dir);
   database.init(dbConfig);
   Tools::ScopeExit dbShutdownOnExit([&database] () { database.shutdown(); });
 
-  if (!CryptoNote::DatabaseBlockchainCache::checkDBSchemeVersion(database, logger))
+  CryptoNote::Currency currency = currencyBuilder.currency();
+
+  std::unique_ptr<CryptoNote::IMainChainStorage> mainChainStorage = CryptoNote::createMainChainStorage(dbConfig.getDataDir(), currency);
+  if (!CryptoNote::DatabaseBlockchainCache::checkDBSchemeVersion(database, logger) ||
+      !CryptoNote::DatabaseBlockchainCache::checkRawBlockStorage(database, *mainChainStorage, logger))
   {
     dbShutdownOnExit.cancel();
     database.shutdown();
@@ -279,8 +283,6 @@ dbConfig.setDataDir(data_dir);
     dbShutdownOnExit.resume();
   }
 
-  CryptoNote::Currency currency = currencyBuilder.currency();
-
   log(Logging::INFO) << "initializing core";
 
   CryptoNote::Core core(
@@ -288,8 +290,8 @@ dbConfig.setDataDir(data_dir);
     logger,
     CryptoNote::Checkpoints(logger),
     *dispatcher,
-    std::unique_ptr<CryptoNote::IBlockchainCacheFactory>(new CryptoNote::DatabaseBlockchainCacheFactory(database, log.getLogger())),
-    CryptoNote::createSwappedMainChainStorage(dbConfig.getDataDir(), currency));
+    std::unique_ptr<CryptoNote::IBlockchainCacheFactory>(new CryptoNote::DatabaseBlockchainCacheFactory(database, log.getLogger(), mainChainStorage.get())),
+    std::move(mainChainStorage));
 
   core.load();
 
@@ -0,0 +1,88 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "BlockFragmentCache.h"
+
+namespace CryptoNote {
+
+BlockFragmentCache::BlockFragmentCache(size_t maxSize) : m_maxSize(maxSize), m_size(0), m_hitCount(0), m_missCount(0) {
+}
+
+BlockFragmentCache::Fragment BlockFragmentCache::find(const Crypto::Hash& blockHash, Format format) {
+  auto it = m_index.find(Key{blockHash, format});
+  if (it == m_index.end()) {
+    ++m_missCount;
+    return Fragment();
+  }
+
+  ++m_hitCount;
+  m_fragments.splice(m_fragments.begin(), m_fragments, it->second);
+  return it->second->second;
+}
+
+BlockFragmentCache::Fragment BlockFragmentCache::insert(const Crypto::Hash& blockHash, Format format, std::string&& fragment) {
+  Key key{blockHash, format};
+  Fragment value = std::make_shared<const std::string>(std::move(fragment));
+
+  auto it = m_index.find(key);
+  if (it != m_index.end()) {
+    m_size -= it->second->second->size();
+    m_fragments.erase(it->second);
+    m_index.erase(it);
+  }
+
+  if (value->size() > m_maxSize) {
+    return value;
+  }
+
+  m_fragments.emplace_front(key, value);
+  m_index.emplace(key, m_fragments.begin());
+  m_size += value->size();
+
+  while (m_size > m_maxSize) {
+    auto& last = m_fragments.back();
+    m_size -= last.second->size();
+    m_index.erase(last.first);
+    m_fragments.pop_back();
+  }
+
+  return value;
+}
+
+void BlockFragmentCache::clear() {
+  m_fragments.clear();
+  m_index.clear();
+  m_size = 0;
+}
+
+uint64_t BlockFragmentCache::getHitCount() const {
+  return m_hitCount;
+}
+
+uint64_t BlockFragmentCache::getMissCount() const {
+  return m_missCount;
+}
+
+size_t BlockFragmentCache::getSize() const {
+  return m_size;
+}
+
+size_t BlockFragmentCache::getFragmentCount() const {
+  return m_index.size();
+}
+
+}
@@ -0,0 +1,79 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "crypto/hash.h"
+
+namespace CryptoNote {
+
+// Size bounded LRU cache of per-block KV binary sections, shared by RPC handlers that return block ranges.
+// Fragments are handed out as shared pointers, so a fragment stays valid after it is evicted.
+class BlockFragmentCache {
+public:
+  enum class Format : uint8_t {
+    RawBlock,
+    BlockShortInfo,
+    BlockDetails
+  };
+
+  typedef std::shared_ptr<const std::string> Fragment;
+
+  explicit BlockFragmentCache(size_t maxSize);
+
+  Fragment find(const Crypto::Hash& blockHash, Format format);
+  Fragment insert(const Crypto::Hash& blockHash, Format format, std::string&& fragment);
+  void clear();
+
+  uint64_t getHitCount() const;
+  uint64_t getMissCount() const;
+  size_t getSize() const;
+  size_t getFragmentCount() const;
+
+private:
+  struct Key {
+    Crypto::Hash blockHash;
+    Format format;
+
+    bool operator==(const Key& other) const {
+      return format == other.format && blockHash == other.blockHash;
+    }
+  };
+
+  struct KeyHasher {
+    size_t operator()(const Key& key) const {
+      return std::hash<Crypto::Hash>()(key.blockHash) ^ static_cast<size_t>(key.format);
+    }
+  };
+
+  typedef std::list<std::pair<Key, Fragment>> FragmentList;
+
+  const size_t m_maxSize;
+  size_t m_size;
+  uint64_t m_hitCount;
+  uint64_t m_missCount;
+  FragmentList m_fragments; // most recently used first
+  std::unordered_map<Key, FragmentList::iterator, KeyHasher> m_index;
+};
+
+}
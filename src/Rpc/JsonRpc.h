@@ -20,6 +20,7 @@
 #include <boost/optional.hpp>
 #include <boost/foreach.hpp>
 #include <functional>
+#include <memory>
 
 #include "CoreRpcServerCommandsDefinitions.h"
 #include <Common/JsonValue.h>
@@ -63,26 +64,35 @@ public:
 
 typedef boost::optional<Common::JsonValue> OptionalId;
 
+template <typename T>
+bool loadMember(JsonInputBufferSerializer& s, T& v, Common::StringView name) {
+  return s(v, name);
+}
+
 class JsonRpcRequest {
 public:
   
-  JsonRpcRequest() : psReq(Common::JsonValue::OBJECT) {}
+  JsonRpcRequest() {}
 
+  // the serializer keeps views into the body, so it gets its own copy
   bool parseRequest(const std::string& requestBody) {
+    return parseRequest(std::string(requestBody));
+  }
+
+  bool parseRequest(std::string&& requestBody) {
     try {
-      psReq = Common::JsonValue::fromString(requestBody);
+      psReq.reset(new JsonInputBufferSerializer(std::move(requestBody)));
     } catch (std::exception&) {
       throw JsonRpcError(errParseError);
     }
 
-    if (!psReq.contains("method")) {
+    if (!(*psReq)(method, "method")) {
       throw JsonRpcError(errInvalidRequest);
     }
 
-    method = psReq("method").getString();
-
-    if (psReq.contains("id")) {
-      id = psReq("id");
+    Common::StringView rawId;
+    if (psReq->rawValue(rawId, "id")) {
+      id = Common::JsonValue::fromString(std::string(rawId));
     }
 
     return true;
@@ -90,14 +100,16 @@ public:
 
   template <typename T>
   bool loadParams(T& v) const {
-    loadFromJsonValue(v, psReq.contains("params") ? 
-      psReq("params") : Common::JsonValue(Common::JsonValue::NIL));
+    if (!psReq || !loadMember(*psReq, v, "params")) {
+      return false;
+    }
+
     return true;
   }
 
   template <typename T>
   bool setParams(const T& v) {
-    psReq.set("params", storeToJsonValue(v));
+    params = storeToJson(v);
     return true;
   }
 
@@ -114,14 +126,21 @@ public:
   }
 
   std::string getBody() {
-    psReq.set("jsonrpc", std::string("2.0"));
-    psReq.set("method", method);
-    return psReq.toString();
+    JsonOutputBufferSerializer s;
+    std::string version = "2.0";
+    s(version, "jsonrpc");
+    s(method, "method");
+    if (!params.empty()) {
+      s.rawValue(params, "params");
+    }
+
+    return s.getBuffer();
   }
 
 private:
 
-  Common::JsonValue psReq;
+  std::unique_ptr<JsonInputBufferSerializer> psReq;
+  std::string params;
   OptionalId id;
   std::string method;
 };
@@ -130,58 +149,70 @@ private:
 class JsonRpcResponse {
 public:
 
-  JsonRpcResponse() : psResp(Common::JsonValue::OBJECT) {}
+  JsonRpcResponse() : hasError(false) {}
 
+  // the serializer keeps views into the body, so it gets its own copy
   void parse(const std::string& responseBody) {
+    parse(std::string(responseBody));
+  }
+
+  void parse(std::string&& responseBody) {
     try {
-      psResp = Common::JsonValue::fromString(responseBody);
+      psResp.reset(new JsonInputBufferSerializer(std::move(responseBody)));
     } catch (std::exception&) {
       throw JsonRpcError(errParseError);
     }
   }
 
   void setId(const OptionalId& id) {
-    if (id.is_initialized()) {
-      psResp.insert("id", id.get());
-    }
+    this->id = id;
   }
 
   void setError(const JsonRpcError& err) {
-    psResp.set("error", storeToJsonValue(err));
+    error = err;
+    hasError = true;
   }
 
   bool getError(JsonRpcError& err) const {
-    if (!psResp.contains("error")) {
-      return false;
-    }
-
-    loadFromJsonValue(err, psResp("error"));
-    return true;
+    return psResp && (*psResp)(err, "error");
   }
 
   std::string getBody() {
-    psResp.set("jsonrpc", std::string("2.0"));
-    return psResp.toString();
+    JsonOutputBufferSerializer s;
+    if (hasError) {
+      s(error, "error");
+    }
+
+    if (id.is_initialized()) {
+      s.rawValue(id.get().toString(), "id");
+    }
+
+    std::string version = "2.0";
+    s(version, "jsonrpc");
+    if (!result.empty()) {
+      s.rawValue(result, "result");
+    }
+
+    return s.getBuffer();
   }
 
   template <typename T>
   bool setResult(const T& v) {
-    psResp.set("result", storeToJsonValue(v));
+    result = storeToJson(v);
     return true;
   }
 
   template <typename T>
   bool getResult(T& v) const {
-    if (!psResp.contains("result")) {
-      return false;
-    }
-
-    loadFromJsonValue(v, psResp("result"));
-    return true;
+    return psResp && loadMember(*psResp, v, "result");
   }
 
 private:
-  Common::JsonValue psResp;
+  std::unique_ptr<JsonInputBufferSerializer> psResp;
+  OptionalId id;
+  JsonRpcError error;
+  bool hasError;
+  std::string result;
 };
 
 
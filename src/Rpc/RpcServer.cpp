@@ -21,6 +21,7 @@
 #include <unordered_map>
 
 // CryptoNote
+#include "Common/StringOutputStream.h"
 #include "Common/StringTools.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "CryptoNoteCore/Core.h"
@@ -31,6 +32,8 @@
 
 #include "P2p/NetNode.h"
 
+#include "Serialization/SerializationTools.h"
+
 #include "CoreRpcServerErrorCodes.h"
 #include "JsonRpc.h"
 
@@ -66,8 +69,30 @@ void serialize(BlockShortInfo& blockShortInfo, ISerializer& s) {
   KV_MEMBER(blockShortInfo.txPrefixes);
 }
 
+void serialize(OutputScanInfo& outputScanInfo, ISerializer& s) {
+  KV_MEMBER(outputScanInfo.amount);
+  KV_MEMBER(outputScanInfo.key);
+  KV_MEMBER(outputScanInfo.globalIndex);
+}
+
+void serialize(TransactionScanInfo& transactionScanInfo, ISerializer& s) {
+  KV_MEMBER(transactionScanInfo.txHash);
+  KV_MEMBER(transactionScanInfo.txPublicKey);
+  KV_MEMBER(transactionScanInfo.unlockTime);
+  KV_MEMBER(transactionScanInfo.outputs);
+  serializeAsBinary(transactionScanInfo.keyImages, "keyImages", s);
+}
+
+void serialize(BlockScanInfo& blockScanInfo, ISerializer& s) {
+  KV_MEMBER(blockScanInfo.blockId);
+  KV_MEMBER(blockScanInfo.timestamp);
+  KV_MEMBER(blockScanInfo.transactions);
+}
+
 namespace {
 
+const size_t BLOCK_FRAGMENT_CACHE_MAX_SIZE = 64 * 1024 * 1024;
+
 template <typename Command>
 RpcServer::HandlerFunction binMethod(bool (RpcServer::*handler)(typename Command::request const&, typename Command::response&)) {
   return [handler](RpcServer* obj, const HttpRequest& request, HttpResponse& response) {
@@ -85,6 +110,28 @@ RpcServer::HandlerFunction binMethod(bool (RpcServer::*handler)(typename Command
   };
 }
 
+// for handlers that assemble the response from cached sections instead of filling Command::response
+template <typename Command>
+RpcServer::HandlerFunction binSectionMethod(bool (RpcServer::*handler)(typename Command::request const&, KVBinaryOutputStreamSerializer&)) {
+  return [handler](RpcServer* obj, const HttpRequest& request, HttpResponse& response) {
+
+    boost::value_initialized<typename Command::request> req;
+    KVBinaryOutputStreamSerializer res;
+
+    if (!loadFromBinaryKeyValue(static_cast<typename Command::request&>(req), request.getBody())) {
+      return false;
+    }
+
+    bool result = (obj->*handler)(req, res);
+
+    std::string body;
+    StringOutputStream stream(body);
+    res.dump(stream);
+    response.setBody(body);
+    return result;
+  };
+}
+
 template <typename Command>
 RpcServer::HandlerFunction jsonMethod(bool (RpcServer::*handler)(typename Command::request const&, typename Command::response&)) {
   return [handler](RpcServer* obj, const HttpRequest& request, HttpResponse& response) {
@@ -108,14 +155,15 @@ RpcServer::HandlerFunction jsonMethod(bool (RpcServer::*handler)(typename Comman
 std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction>> RpcServer::s_handlers = {
   
   // binary handlers
-  { "/getblocks.bin", { binMethod<COMMAND_RPC_GET_BLOCKS_FAST>(&RpcServer::on_get_blocks), false } },
+  { "/getblocks.bin", { binSectionMethod<COMMAND_RPC_GET_BLOCKS_FAST>(&RpcServer::on_get_blocks), false } },
   { "/queryblocks.bin", { binMethod<COMMAND_RPC_QUERY_BLOCKS>(&RpcServer::on_query_blocks), false } },
-  { "/queryblockslite.bin", { binMethod<COMMAND_RPC_QUERY_BLOCKS_LITE>(&RpcServer::on_query_blocks_lite), false } },
+  { "/queryblockslite.bin", { binSectionMethod<COMMAND_RPC_QUERY_BLOCKS_LITE>(&RpcServer::on_query_blocks_lite), false } },
+  { "/queryblocksscan.bin", { binMethod<COMMAND_RPC_QUERY_BLOCKS_SCAN>(&RpcServer::on_query_blocks_scan), false } },
   { "/get_o_indexes.bin", { binMethod<COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES>(&RpcServer::on_get_indexes), false } },
   { "/getrandom_outs.bin", { binMethod<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS>(&RpcServer::on_get_random_outs), false } },
   { "/get_pool_changes.bin", { binMethod<COMMAND_RPC_GET_POOL_CHANGES>(&RpcServer::onGetPoolChanges), false } },
   { "/get_pool_changes_lite.bin", { binMethod<COMMAND_RPC_GET_POOL_CHANGES_LITE>(&RpcServer::onGetPoolChangesLite), false } },
-  { "/get_blocks_details_by_hashes.bin", { binMethod<COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES>(&RpcServer::onGetBlocksDetailsByHashes), false } },
+  { "/get_blocks_details_by_hashes.bin", { binSectionMethod<COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES>(&RpcServer::onGetBlocksDetailsByHashes), false } },
   { "/get_blocks_hashes_by_timestamps.bin", { binMethod<COMMAND_RPC_GET_BLOCKS_HASHES_BY_TIMESTAMPS>(&RpcServer::onGetBlocksHashesByTimestamps), false } },
   { "/get_transaction_details_by_hashes.bin", { binMethod<COMMAND_RPC_GET_TRANSACTION_DETAILS_BY_HASHES>(&RpcServer::onGetTransactionDetailsByHashes), false } },
   { "/get_transaction_hashes_by_payment_id.bin", { binMethod<COMMAND_RPC_GET_TRANSACTION_HASHES_BY_PAYMENT_ID>(&RpcServer::onGetTransactionHashesByPaymentId), false } },
@@ -134,7 +182,25 @@ std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction
 };
 
 RpcServer::RpcServer(System::Dispatcher& dispatcher, Logging::ILogger& log, Core& c, NodeServer& p2p, ICryptoNoteProtocolHandler& protocol) :
-  HttpServer(dispatcher, log), logger(log, "RpcServer"), m_core(c), m_p2p(p2p), m_protocol(protocol) {
+  HttpServer(dispatcher, log), logger(log, "RpcServer"), m_core(c), m_p2p(p2p), m_protocol(protocol),
+  m_blockFragments(BLOCK_FRAGMENT_CACHE_MAX_SIZE), m_messageQueue(dispatcher), m_messageQueueGuard(c, m_messageQueue),
+  m_messageContext(dispatcher) {
+  m_messageContext.spawn(std::bind(&RpcServer::blockchainMessageLoop, this));
+}
+
+void RpcServer::blockchainMessageLoop() {
+  try {
+    while (true) {
+      // details of the switched blocks change, e.g. isAlternative, so every format is dropped to stay simple
+      if (m_messageQueue.front().getType() == BlockchainMessage::Type::ChainSwitch) {
+        logger(DEBUGGING) << "Chain switched, dropping " << m_blockFragments.getFragmentCount() << " cached block fragments";
+        m_blockFragments.clear();
+      }
+
+      m_messageQueue.pop();
+    }
+  } catch (System::InterruptedException&) {
+  }
 }
 
 void RpcServer::processRequest(const HttpRequest& request, HttpResponse& response) {
@@ -211,7 +277,7 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
   }
 
   response.setBody(jsonResponse.getBody());
-  logger(TRACE) << "JSON-RPC response: " << jsonResponse.getBody();
+  logger(TRACE) << "JSON-RPC response: " << response.getBody();
   return true;
 }
 
@@ -233,15 +299,12 @@ bool RpcServer::isCoreReady() {
 // Binary handlers
 //
 
-bool RpcServer::on_get_blocks(const COMMAND_RPC_GET_BLOCKS_FAST::request& req, COMMAND_RPC_GET_BLOCKS_FAST::response& res) {
+bool RpcServer::on_get_blocks(const COMMAND_RPC_GET_BLOCKS_FAST::request& req, KVBinaryOutputStreamSerializer& res) {
   // TODO code duplication see InProcessNode::doGetNewBlocks()
-  if (req.block_ids.empty()) {
-    res.status = "Failed";
-    return false;
-  }
-
-  if (req.block_ids.back() != m_core.getBlockHashByIndex(0)) {
-    res.status = "Failed";
+  COMMAND_RPC_GET_BLOCKS_FAST::response rsp = boost::value_initialized<COMMAND_RPC_GET_BLOCKS_FAST::response>();
+  if (req.block_ids.empty() || req.block_ids.back() != m_core.getBlockHashByIndex(0)) {
+    rsp.status = "Failed";
+    serialize(rsp, res);
     return false;
   }
 
@@ -249,14 +312,45 @@ bool RpcServer::on_get_blocks(const COMMAND_RPC_GET_BLOCKS_FAST::request& req, C
   uint32_t startBlockIndex;
   std::vector<Crypto::Hash> supplement = m_core.findBlockchainSupplement(req.block_ids, COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT, totalBlockCount, startBlockIndex);
 
-  res.current_height = totalBlockCount;
-  res.start_height = startBlockIndex;
-
+  std::vector<BlockFragmentCache::Fragment> fragments;
   std::vector<Crypto::Hash> missedHashes;
-  m_core.getBlocks(supplement, res.blocks, missedHashes);
-  assert(missedHashes.empty());
+  fragments.reserve(supplement.size());
+  for (const auto& hash : supplement) {
+    fragments.push_back(m_blockFragments.find(hash, BlockFragmentCache::Format::RawBlock));
+    if (!fragments.back()) {
+      missedHashes.push_back(hash);
+    }
+  }
 
-  res.status = CORE_RPC_STATUS_OK;
+  if (!missedHashes.empty()) {
+    std::vector<RawBlock> blocks;
+    std::vector<Crypto::Hash> notFound;
+    m_core.getBlocks(missedHashes, blocks, notFound);
+    assert(notFound.empty());
+    assert(blocks.size() == missedHashes.size());
+
+    auto block = blocks.begin();
+    for (size_t i = 0; i < fragments.size(); ++i) {
+      if (!fragments[i]) {
+        fragments[i] = m_blockFragments.insert(supplement[i], BlockFragmentCache::Format::RawBlock, storeToBinaryKeyValueSection(*block++));
+      }
+    }
+  }
+
+  // members go in the order of serialize(COMMAND_RPC_GET_BLOCKS_FAST::response&)
+  size_t blockCount = fragments.size();
+  res.beginArray(blockCount, "blocks");
+  for (const auto& fragment : fragments) {
+    res.writeSection(*fragment, "");
+  }
+  res.endArray();
+
+  uint64_t startHeight = startBlockIndex;
+  uint64_t currentHeight = totalBlockCount;
+  std::string status = CORE_RPC_STATUS_OK;
+  res(startHeight, "start_height");
+  res(currentHeight, "current_height");
+  res(status, "status");
   return true;
 }
 
@@ -277,11 +371,68 @@ bool RpcServer::on_query_blocks(const COMMAND_RPC_QUERY_BLOCKS::request& req, CO
   return true;
 }
 
-bool RpcServer::on_query_blocks_lite(const COMMAND_RPC_QUERY_BLOCKS_LITE::request& req, COMMAND_RPC_QUERY_BLOCKS_LITE::response& res) {
+bool RpcServer::on_query_blocks_lite(const COMMAND_RPC_QUERY_BLOCKS_LITE::request& req, KVBinaryOutputStreamSerializer& res) {
+  std::unordered_map<Crypto::Hash, BlockFragmentCache::Fragment> cachedBlocks;
+  auto needFullInfo = [this, &cachedBlocks](const Crypto::Hash& hash) {
+    auto fragment = m_blockFragments.find(hash, BlockFragmentCache::Format::BlockShortInfo);
+    if (!fragment) {
+      return true;
+    }
+
+    cachedBlocks.emplace(hash, std::move(fragment));
+    return false;
+  };
+
+  COMMAND_RPC_QUERY_BLOCKS_LITE::response rsp = boost::value_initialized<COMMAND_RPC_QUERY_BLOCKS_LITE::response>();
+  uint32_t startIndex;
+  uint32_t currentIndex;
+  uint32_t fullOffset;
+  if (!m_core.queryBlocksLite(req.blockIds, req.timestamp, startIndex, currentIndex, fullOffset, rsp.items, needFullInfo)) {
+    rsp.items.clear();
+    rsp.status = "Failed to perform query";
+    serialize(rsp, res);
+    return false;
+  }
+
+  rsp.startHeight = startIndex;
+  rsp.currentHeight = currentIndex;
+  rsp.fullOffset = fullOffset;
+  rsp.status = CORE_RPC_STATUS_OK;
+
+  // members go in the order of COMMAND_RPC_QUERY_BLOCKS_LITE::response::serialize()
+  res(rsp.status, "status");
+  res(rsp.startHeight, "startHeight");
+  res(rsp.currentHeight, "currentHeight");
+  res(rsp.fullOffset, "fullOffset");
+
+  size_t itemCount = rsp.items.size();
+  res.beginArray(itemCount, "items");
+  for (size_t i = 0; i < rsp.items.size(); ++i) {
+    auto& item = rsp.items[i];
+
+    // entries before the full offset carry only the block hash and are never cached
+    if (startIndex + i < fullOffset) {
+      res(item, "");
+      continue;
+    }
+
+    auto cachedIt = cachedBlocks.find(item.blockId);
+    if (cachedIt != cachedBlocks.end()) {
+      res.writeSection(*cachedIt->second, "");
+    } else {
+      res.writeSection(*m_blockFragments.insert(item.blockId, BlockFragmentCache::Format::BlockShortInfo, storeToBinaryKeyValueSection(item)), "");
+    }
+  }
+
+  res.endArray();
+  return true;
+}
+
+bool RpcServer::on_query_blocks_scan(const COMMAND_RPC_QUERY_BLOCKS_SCAN::request& req, COMMAND_RPC_QUERY_BLOCKS_SCAN::response& res) {
   uint32_t startIndex;
   uint32_t currentIndex;
   uint32_t fullOffset;
-  if (!m_core.queryBlocksLite(req.blockIds, req.timestamp, startIndex, currentIndex, fullOffset, res.items)) {
+  if (!m_core.queryBlocksScan(req.blockIds, req.timestamp, startIndex, currentIndex, fullOffset, res.items)) {
     res.status = "Failed to perform query";
     return false;
   }
@@ -386,23 +537,40 @@ bool RpcServer::onGetPoolChangesLite(const COMMAND_RPC_GET_POOL_CHANGES_LITE::re
   return true;
 }
 
-bool RpcServer::onGetBlocksDetailsByHashes(const COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES::request& req, COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES::response& rsp) {
+bool RpcServer::onGetBlocksDetailsByHashes(const COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES::request& req, KVBinaryOutputStreamSerializer& rsp) {
+  COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES::response failed;
+  std::vector<BlockFragmentCache::Fragment> fragments;
   try {
-    std::vector<BlockDetails> blockDetails;
+    fragments.reserve(req.blockHashes.size());
     for (const Crypto::Hash& hash : req.blockHashes) {
-      blockDetails.push_back(m_core.getBlockDetails(hash));
-    }
+      auto fragment = m_blockFragments.find(hash, BlockFragmentCache::Format::BlockDetails);
+      if (!fragment) {
+        fragment = m_blockFragments.insert(hash, BlockFragmentCache::Format::BlockDetails, storeToBinaryKeyValueSection(m_core.getBlockDetails(hash)));
+      }
 
-    rsp.blocks = std::move(blockDetails);
+      fragments.push_back(std::move(fragment));
+    }
   } catch (std::system_error& e) {
-    rsp.status = e.what();
+    failed.status = e.what();
+    failed.serialize(rsp);
     return false;
   } catch (std::exception& e) {
-    rsp.status = "Error: " + std::string(e.what());
+    failed.status = "Error: " + std::string(e.what());
+    failed.serialize(rsp);
     return false;
   }
 
-  rsp.status = CORE_RPC_STATUS_OK;
+  // members go in the order of COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES::response::serialize()
+  std::string status = CORE_RPC_STATUS_OK;
+  rsp(status, "status");
+
+  size_t blockCount = fragments.size();
+  rsp.beginArray(blockCount, "blocks");
+  for (const auto& fragment : fragments) {
+    rsp.writeSection(*fragment, "");
+  }
+  rsp.endArray();
+
   return true;
 }
 
@@ -475,6 +643,8 @@ bool RpcServer::on_get_info(const COMMAND_RPC_GET_INFO::request& req, COMMAND_RP
   res.white_peerlist_size = m_p2p.getPeerlistManager().get_white_peers_count();
   res.grey_peerlist_size = m_p2p.getPeerlistManager().get_gray_peers_count();
   res.last_known_block_index = std::max(static_cast<uint32_t>(1), m_protocol.getObservedHeight()) - 1;
+  res.block_fragment_cache_hits = m_blockFragments.getHitCount();
+  res.block_fragment_cache_misses = m_blockFragments.getMissCount();
   res.status = CORE_RPC_STATUS_OK;
   return true;
 }
@@ -0,0 +1,501 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "JsonInputBufferSerializer.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+
+#include "Common/StringTools.h"
+
+using namespace CryptoNote;
+
+namespace CryptoNote {
+std::ostream& operator<<(std::ostream& out, const JsonInputBufferSerializer& serializer) {
+  out.write(serializer.buffer.getData(), serializer.buffer.getSize());
+  return out;
+}
+}
+
+namespace {
+
+[[noreturn]] void throwParseError() {
+  throw std::runtime_error("Unable to parse");
+}
+
+const char* skipWhitespace(const char* it, const char* end) {
+  while (it != end && (*it == ' ' || *it == '\t' || *it == '\n' || *it == '\r')) {
+    ++it;
+  }
+
+  if (it == end) {
+    throw std::runtime_error("Unable to parse: unexpected end of stream");
+  }
+
+  return it;
+}
+
+bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+bool equals(const char* data, size_t size, Common::StringView name) {
+  return size == name.getSize() && memcmp(data, name.getData(), size) == 0;
+}
+
+}
+
+JsonInputBufferSerializer::JsonInputBufferSerializer(Common::StringView buffer) : buffer(buffer) {
+  parse();
+}
+
+JsonInputBufferSerializer::JsonInputBufferSerializer(std::string&& buffer) : ownBuffer(std::move(buffer)), buffer(ownBuffer) {
+  parse();
+}
+
+JsonInputBufferSerializer::~JsonInputBufferSerializer() {
+}
+
+ISerializer::SerializerType JsonInputBufferSerializer::type() const {
+  return ISerializer::INPUT;
+}
+
+bool JsonInputBufferSerializer::beginObject(Common::StringView name) {
+  const Token* token = getValue(name);
+  if (token == nullptr) {
+    return false;
+  }
+
+  if (token->type != TokenType::OBJECT) {
+    throw std::runtime_error("JSON value type is not OBJECT");
+  }
+
+  size_t index = token - tokens.data();
+  chain.push_back(Level{index, index + 1});
+  return true;
+}
+
+void JsonInputBufferSerializer::endObject() {
+  assert(chain.size() > 1);
+  chain.pop_back();
+}
+
+bool JsonInputBufferSerializer::beginArray(size_t& size, Common::StringView name) {
+  const Token* token = getValue(name);
+  if (token == nullptr) {
+    size = 0;
+    return false;
+  }
+
+  if (token->type != TokenType::ARRAY) {
+    throw std::runtime_error("JSON value type is not ARRAY");
+  }
+
+  size = token->count;
+  size_t index = token - tokens.data();
+  chain.push_back(Level{index, index + 1});
+  return true;
+}
+
+void JsonInputBufferSerializer::endArray() {
+  assert(chain.size() > 1);
+  chain.pop_back();
+}
+
+bool JsonInputBufferSerializer::operator()(uint16_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputBufferSerializer::operator()(int16_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputBufferSerializer::operator()(uint32_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputBufferSerializer::operator()(int32_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputBufferSerializer::operator()(int64_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputBufferSerializer::operator()(uint64_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputBufferSerializer::operator()(uint8_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputBufferSerializer::operator()(double& value, Common::StringView name) {
+  const Token* token = getValue(name);
+  if (token == nullptr) {
+    return false;
+  }
+
+  if (token->type != TokenType::INTEGER && token->type != TokenType::REAL) {
+    throw std::runtime_error("JSON value type is not REAL");
+  }
+
+  value = strtod(std::string(buffer.getData() + token->offset, token->size).c_str(), nullptr);
+  return true;
+}
+
+bool JsonInputBufferSerializer::operator()(std::string& value, Common::StringView name) {
+  const Token* token = getValue(name);
+  if (token == nullptr) {
+    return false;
+  }
+
+  Common::StringView text = getString(*token);
+  value.assign(text.getData(), text.getSize());
+  return true;
+}
+
+bool JsonInputBufferSerializer::operator()(bool& value, Common::StringView name) {
+  const Token* token = getValue(name);
+  if (token == nullptr) {
+    return false;
+  }
+
+  if (token->type == TokenType::TRUE_VALUE) {
+    value = true;
+  } else if (token->type == TokenType::FALSE_VALUE) {
+    value = false;
+  } else {
+    throw std::runtime_error("JSON value type is not BOOL");
+  }
+
+  return true;
+}
+
+bool JsonInputBufferSerializer::binary(void* value, size_t size, Common::StringView name) {
+  const Token* token = getValue(name);
+  if (token == nullptr) {
+    return false;
+  }
+
+  Common::StringView text = getString(*token);
+  if ((text.getSize() & 1) != 0) {
+    throw std::runtime_error("fromHex: invalid string size");
+  }
+
+  if (text.getSize() >> 1 > size) {
+    throw std::runtime_error("fromHex: invalid buffer size");
+  }
+
+  const char* hex = text.getData();
+  for (size_t i = 0; i < text.getSize() >> 1; ++i) {
+    static_cast<uint8_t*>(value)[i] = Common::fromHex(hex[i << 1]) << 4 | Common::fromHex(hex[(i << 1) + 1]);
+  }
+
+  return true;
+}
+
+bool JsonInputBufferSerializer::binary(std::string& value, Common::StringView name) {
+  const Token* token = getValue(name);
+  if (token == nullptr) {
+    return false;
+  }
+
+  Common::StringView text = getString(*token);
+  if ((text.getSize() & 1) != 0) {
+    throw std::runtime_error("fromHex: invalid string size");
+  }
+
+  const char* hex = text.getData();
+  value.resize(text.getSize() >> 1);
+  for (size_t i = 0; i < value.size(); ++i) {
+    value[i] = static_cast<char>(Common::fromHex(hex[i << 1]) << 4 | Common::fromHex(hex[(i << 1) + 1]));
+  }
+
+  return true;
+}
+
+bool JsonInputBufferSerializer::rawValue(Common::StringView& json, Common::StringView name) {
+  const Token* token = getValue(name);
+  if (token == nullptr) {
+    return false;
+  }
+
+  json = Common::StringView(buffer.getData() + token->offset, token->size);
+  return true;
+}
+
+void JsonInputBufferSerializer::parse() {
+  const char* begin = buffer.getData();
+  parseValue(begin, begin + buffer.getSize());
+  if (tokens.front().type != TokenType::OBJECT) {
+    throw std::runtime_error("Serializer doesn't support this type of serialization: Object expected.");
+  }
+
+  chain.push_back(Level{0, 1});
+}
+
+const char* JsonInputBufferSerializer::parseValue(const char* it, const char* end) {
+  it = skipWhitespace(it, end);
+
+  size_t index = tokens.size();
+  tokens.push_back(Token{TokenType::NIL, static_cast<size_t>(it - buffer.getData()), 0, 0, 0});
+
+  char c = *it;
+  if (c == '{') {
+    it = parseObject(index, it + 1, end);
+  } else if (c == '[') {
+    it = parseArray(index, it + 1, end);
+  } else if (c == '"') {
+    tokens[index].type = TokenType::STRING;
+    it = parseString(it + 1, end);
+  } else if (c == '-' || isDigit(c)) {
+    it = parseNumber(index, it, end);
+  } else {
+    it = parseLiteral(index, it, end);
+  }
+
+  Token& token = tokens[index];
+  token.size = static_cast<size_t>(it - buffer.getData()) - token.offset;
+  token.next = tokens.size();
+  return it;
+}
+
+const char* JsonInputBufferSerializer::parseObject(size_t index, const char* it, const char* end) {
+  tokens[index].type = TokenType::OBJECT;
+  it = skipWhitespace(it, end);
+  if (*it == '}') {
+    return it + 1;
+  }
+
+  for (;;) {
+    if (*it != '"') {
+      throwParseError();
+    }
+
+    it = parseValue(it, end);
+    it = skipWhitespace(it, end);
+    if (*it != ':') {
+      throwParseError();
+    }
+
+    it = parseValue(it + 1, end);
+    ++tokens[index].count;
+
+    it = skipWhitespace(it, end);
+    if (*it == '}') {
+      return it + 1;
+    }
+
+    if (*it != ',') {
+      throwParseError();
+    }
+
+    it = skipWhitespace(it + 1, end);
+  }
+}
+
+const char* JsonInputBufferSerializer::parseArray(size_t index, const char* it, const char* end) {
+  tokens[index].type = TokenType::ARRAY;
+  it = skipWhitespace(it, end);
+  if (*it == ']') {
+    return it + 1;
+  }
+
+  for (;;) {
+    it = parseValue(it, end);
+    ++tokens[index].count;
+
+    it = skipWhitespace(it, end);
+    if (*it == ']') {
+      return it + 1;
+    }
+
+    if (*it != ',') {
+      throwParseError();
+    }
+
+    ++it;
+  }
+}
+
+// Escape sequences are kept as is, the same way JsonValue does
+const char* JsonInputBufferSerializer::parseString(const char* it, const char* end) {
+  for (;;) {
+    if (it == end) {
+      throw std::runtime_error("Unable to parse: unexpected end of stream");
+    }
+
+    if (*it == '"') {
+      return it + 1;
+    }
+
+    if (*it == '\\') {
+      ++it;
+      if (it == end) {
+        throw std::runtime_error("Unable to parse: unexpected end of stream");
+      }
+    }
+
+    ++it;
+  }
+}
+
+const char* JsonInputBufferSerializer::parseNumber(size_t index, const char* it, const char* end) {
+  tokens[index].type = TokenType::INTEGER;
+  if (*it == '-') {
+    ++it;
+  }
+
+  if (it == end || !isDigit(*it)) {
+    throwParseError();
+  }
+
+  if (*it == '0' && it + 1 != end && isDigit(it[1])) {
+    throwParseError();
+  }
+
+  while (it != end && isDigit(*it)) {
+    ++it;
+  }
+
+  if (it != end && *it == '.') {
+    tokens[index].type = TokenType::REAL;
+    ++it;
+    if (it == end || !isDigit(*it)) {
+      throwParseError();
+    }
+
+    while (it != end && isDigit(*it)) {
+      ++it;
+    }
+  }
+
+  if (it != end && (*it == 'e' || *it == 'E')) {
+    tokens[index].type = TokenType::REAL;
+    ++it;
+    if (it != end && (*it == '+' || *it == '-')) {
+      ++it;
+    }
+
+    if (it == end || !isDigit(*it)) {
+      throwParseError();
+    }
+
+    while (it != end && isDigit(*it)) {
+      ++it;
+    }
+  }
+
+  return it;
+}
+
+const char* JsonInputBufferSerializer::parseLiteral(size_t index, const char* it, const char* end) {
+  size_t left = static_cast<size_t>(end - it);
+  if (left >= 4 && memcmp(it, "true", 4) == 0) {
+    tokens[index].type = TokenType::TRUE_VALUE;
+    return it + 4;
+  }
+
+  if (left >= 5 && memcmp(it, "false", 5) == 0) {
+    tokens[index].type = TokenType::FALSE_VALUE;
+    return it + 5;
+  }
+
+  if (left >= 4 && memcmp(it, "null", 4) == 0) {
+    tokens[index].type = TokenType::NIL;
+    return it + 4;
+  }
+
+  throwParseError();
+}
+
+const JsonInputBufferSerializer::Token* JsonInputBufferSerializer::getValue(Common::StringView name) {
+  assert(!chain.empty());
+  Level& level = chain.back();
+  const Token& parent = tokens[level.token];
+  if (parent.type == TokenType::ARRAY) {
+    if (level.cursor == parent.next) {
+      throw std::runtime_error("JSON array index is out of range");
+    }
+
+    const Token* token = &tokens[level.cursor];
+    level.cursor = token->next;
+    return token;
+  }
+
+  return findMember(level, name);
+}
+
+// Members are usually read in the order they were written, so the lookup starts right after the previous match
+const JsonInputBufferSerializer::Token* JsonInputBufferSerializer::findMember(Level& level, Common::StringView name) {
+  const Token& parent = tokens[level.token];
+  const char* data = buffer.getData();
+
+  for (size_t pass = 0; pass < 2; ++pass) {
+    size_t key = pass == 0 ? level.cursor : level.token + 1;
+    size_t last = pass == 0 ? parent.next : level.cursor;
+    while (key < last) {
+      const Token& keyToken = tokens[key];
+      const Token& valueToken = tokens[key + 1];
+      if (equals(data + keyToken.offset + 1, keyToken.size - 2, name)) {
+        level.cursor = valueToken.next;
+        return &valueToken;
+      }
+
+      key = valueToken.next;
+    }
+  }
+
+  return nullptr;
+}
+
+Common::StringView JsonInputBufferSerializer::getString(const Token& token) const {
+  if (token.type != TokenType::STRING) {
+    throw std::runtime_error("JSON value type is not STRING");
+  }
+
+  return Common::StringView(buffer.getData() + token.offset + 1, token.size - 2);
+}
+
+uint64_t JsonInputBufferSerializer::getInteger(const Token& token, bool& negative) const {
+  if (token.type != TokenType::INTEGER) {
+    throw std::runtime_error("JSON value type is not INTEGER");
+  }
+
+  const char* it = buffer.getData() + token.offset;
+  const char* end = it + token.size;
+  negative = *it == '-';
+  if (negative) {
+    ++it;
+  }
+
+  uint64_t value = 0;
+  for (; it != end; ++it) {
+    uint64_t digit = static_cast<uint64_t>(*it - '0');
+    if (value > (UINT64_MAX - digit) / 10) {
+      throw std::runtime_error("JSON integer value is out of range");
+    }
+
+    value = value * 10 + digit;
+  }
+
+  return value;
+}
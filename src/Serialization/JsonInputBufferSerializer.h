@@ -0,0 +1,126 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "ISerializer.h"
+
+namespace CryptoNote {
+
+// Reads JSON text from a contiguous buffer without building a JsonValue tree.
+// The buffer is scanned once into a flat token list, values are decoded only when requested.
+class JsonInputBufferSerializer : public ISerializer {
+public:
+  JsonInputBufferSerializer(Common::StringView buffer);
+  JsonInputBufferSerializer(std::string&& buffer);
+  JsonInputBufferSerializer(const JsonInputBufferSerializer&) = delete;
+  virtual ~JsonInputBufferSerializer();
+
+  SerializerType type() const override;
+
+  virtual bool beginObject(Common::StringView name) override;
+  virtual void endObject() override;
+
+  virtual bool beginArray(size_t& size, Common::StringView name) override;
+  virtual void endArray() override;
+
+  virtual bool operator()(uint8_t& value, Common::StringView name) override;
+  virtual bool operator()(int16_t& value, Common::StringView name) override;
+  virtual bool operator()(uint16_t& value, Common::StringView name) override;
+  virtual bool operator()(int32_t& value, Common::StringView name) override;
+  virtual bool operator()(uint32_t& value, Common::StringView name) override;
+  virtual bool operator()(int64_t& value, Common::StringView name) override;
+  virtual bool operator()(uint64_t& value, Common::StringView name) override;
+  virtual bool operator()(double& value, Common::StringView name) override;
+  virtual bool operator()(bool& value, Common::StringView name) override;
+  virtual bool operator()(std::string& value, Common::StringView name) override;
+  virtual bool binary(void* value, size_t size, Common::StringView name) override;
+  virtual bool binary(std::string& value, Common::StringView name) override;
+
+  template<typename T>
+  bool operator()(T& value, Common::StringView name) {
+    return ISerializer::operator()(value, name);
+  }
+
+  // Returns JSON text of 'name' as is, the view points into the source buffer
+  bool rawValue(Common::StringView& json, Common::StringView name);
+
+  friend std::ostream& operator<<(std::ostream& out, const JsonInputBufferSerializer& serializer);
+
+private:
+  enum class TokenType : uint8_t {
+    OBJECT,
+    ARRAY,
+    STRING,
+    INTEGER,
+    REAL,
+    TRUE_VALUE,
+    FALSE_VALUE,
+    NIL
+  };
+
+  struct Token {
+    TokenType type;
+    size_t offset;
+    size_t size;
+    size_t count; // members of object or elements of array
+    size_t next; // index of the token following the whole value
+  };
+
+  struct Level {
+    size_t token;
+    size_t cursor; // next array element or member to start lookup from
+  };
+
+  void parse();
+  const char* parseValue(const char* it, const char* end);
+  const char* parseObject(size_t index, const char* it, const char* end);
+  const char* parseArray(size_t index, const char* it, const char* end);
+  const char* parseString(const char* it, const char* end);
+  const char* parseNumber(size_t index, const char* it, const char* end);
+  const char* parseLiteral(size_t index, const char* it, const char* end);
+
+  const Token* getValue(Common::StringView name);
+  const Token* findMember(Level& level, Common::StringView name);
+  Common::StringView getString(const Token& token) const;
+
+  template <typename T>
+  bool getNumber(Common::StringView name, T& v) {
+    auto ptr = getValue(name);
+
+    if (!ptr) {
+      return false;
+    }
+
+    bool negative;
+    uint64_t magnitude = getInteger(*ptr, negative);
+    v = negative ? static_cast<T>(static_cast<int64_t>(0 - magnitude)) : static_cast<T>(magnitude);
+    return true;
+  }
+
+  uint64_t getInteger(const Token& token, bool& negative) const;
+
+  std::string ownBuffer;
+  Common::StringView buffer;
+  std::vector<Token> tokens;
+  std::vector<Level> chain;
+};
+
+}
@@ -0,0 +1,204 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "JsonOutputBufferSerializer.h"
+#include <cassert>
+#include <cstdio>
+#include <ostream>
+#include <stdexcept>
+#include "Common/StringTools.h"
+
+using namespace CryptoNote;
+
+namespace CryptoNote {
+std::ostream& operator<<(std::ostream& out, JsonOutputBufferSerializer& serializer) {
+  out << serializer.getBuffer();
+  return out;
+}
+}
+
+JsonOutputBufferSerializer::JsonOutputBufferSerializer() {
+  buffer += '{';
+  chain.push_back(Level{false, true});
+}
+
+JsonOutputBufferSerializer::~JsonOutputBufferSerializer() {
+}
+
+ISerializer::SerializerType JsonOutputBufferSerializer::type() const {
+  return ISerializer::OUTPUT;
+}
+
+bool JsonOutputBufferSerializer::beginObject(Common::StringView name) {
+  writeName(name);
+  buffer += '{';
+  chain.push_back(Level{false, true});
+  return true;
+}
+
+void JsonOutputBufferSerializer::endObject() {
+  assert(chain.size() > 1 && !chain.back().isArray);
+  chain.pop_back();
+  buffer += '}';
+}
+
+bool JsonOutputBufferSerializer::beginArray(size_t& size, Common::StringView name) {
+  writeName(name);
+  buffer += '[';
+  chain.push_back(Level{true, true});
+  return true;
+}
+
+void JsonOutputBufferSerializer::endArray() {
+  assert(chain.size() > 1 && chain.back().isArray);
+  chain.pop_back();
+  buffer += ']';
+}
+
+// Unsigned 64-bit values are written as signed ones, the same way JsonOutputStreamSerializer does,
+// so that JsonValue based readers keep getting them back unchanged.
+bool JsonOutputBufferSerializer::operator()(uint64_t& value, Common::StringView name) {
+  writeName(name);
+  writeInteger(static_cast<int64_t>(value));
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(uint16_t& value, Common::StringView name) {
+  writeName(name);
+  writeInteger(value);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(int16_t& value, Common::StringView name) {
+  writeName(name);
+  writeInteger(value);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(uint32_t& value, Common::StringView name) {
+  writeName(name);
+  writeInteger(value);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(int32_t& value, Common::StringView name) {
+  writeName(name);
+  writeInteger(value);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(int64_t& value, Common::StringView name) {
+  writeName(name);
+  writeInteger(value);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(double& value, Common::StringView name) {
+  char text[512];
+  int length = snprintf(text, sizeof(text), "%.11f", value);
+  if (length < 0 || static_cast<size_t>(length) >= sizeof(text)) {
+    throw std::runtime_error("Unable to format double value");
+  }
+
+  while (length > 1 && text[length - 2] != '.' && text[length - 1] == '0') {
+    --length;
+  }
+
+  writeName(name);
+  buffer.append(text, length);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(std::string& value, Common::StringView name) {
+  writeName(name);
+  buffer += '"';
+  buffer += value;
+  buffer += '"';
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(uint8_t& value, Common::StringView name) {
+  writeName(name);
+  writeInteger(value);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(bool& value, Common::StringView name) {
+  writeName(name);
+  buffer += value ? "true" : "false";
+  return true;
+}
+
+bool JsonOutputBufferSerializer::binary(void* value, size_t size, Common::StringView name) {
+  writeName(name);
+  buffer += '"';
+  Common::toHex(value, size, buffer);
+  buffer += '"';
+  return true;
+}
+
+bool JsonOutputBufferSerializer::binary(std::string& value, Common::StringView name) {
+  return binary(const_cast<char*>(value.data()), value.size(), name);
+}
+
+bool JsonOutputBufferSerializer::rawValue(Common::StringView json, Common::StringView name) {
+  writeName(name);
+  buffer.append(json.getData(), json.getSize());
+  return true;
+}
+
+const std::string& JsonOutputBufferSerializer::getBuffer() {
+  if (!chain.empty()) {
+    assert(chain.size() == 1);
+    chain.pop_back();
+    buffer += '}';
+  }
+
+  return buffer;
+}
+
+void JsonOutputBufferSerializer::writeName(Common::StringView name) {
+  assert(!chain.empty());
+  Level& level = chain.back();
+  if (!level.isEmpty) {
+    buffer += ',';
+  }
+
+  level.isEmpty = false;
+  if (!level.isArray) {
+    buffer += '"';
+    buffer.append(name.getData(), name.getSize());
+    buffer += "\":";
+  }
+}
+
+void JsonOutputBufferSerializer::writeInteger(int64_t value) {
+  char text[20];
+  char* end = text + sizeof(text);
+  char* begin = end;
+  uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+  do {
+    *--begin = static_cast<char>('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude != 0);
+
+  if (value < 0) {
+    buffer += '-';
+  }
+
+  buffer.append(begin, end);
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "ISerializer.h"
+
+namespace CryptoNote {
+
+// Writes JSON text straight into a contiguous buffer, without building a JsonValue tree.
+// Output is compatible with JsonOutputStreamSerializer except for member order, which follows serialization order.
+class JsonOutputBufferSerializer : public ISerializer {
+public:
+  JsonOutputBufferSerializer();
+  virtual ~JsonOutputBufferSerializer();
+
+  SerializerType type() const override;
+
+  virtual bool beginObject(Common::StringView name) override;
+  virtual void endObject() override;
+
+  virtual bool beginArray(size_t& size, Common::StringView name) override;
+  virtual void endArray() override;
+
+  virtual bool operator()(uint8_t& value, Common::StringView name) override;
+  virtual bool operator()(int16_t& value, Common::StringView name) override;
+  virtual bool operator()(uint16_t& value, Common::StringView name) override;
+  virtual bool operator()(int32_t& value, Common::StringView name) override;
+  virtual bool operator()(uint32_t& value, Common::StringView name) override;
+  virtual bool operator()(int64_t& value, Common::StringView name) override;
+  virtual bool operator()(uint64_t& value, Common::StringView name) override;
+  virtual bool operator()(double& value, Common::StringView name) override;
+  virtual bool operator()(bool& value, Common::StringView name) override;
+  virtual bool operator()(std::string& value, Common::StringView name) override;
+  virtual bool binary(void* value, size_t size, Common::StringView name) override;
+  virtual bool binary(std::string& value, Common::StringView name) override;
+
+  template<typename T>
+  bool operator()(T& value, Common::StringView name) {
+    return ISerializer::operator()(value, name);
+  }
+
+  // Writes already serialized JSON text as the value of 'name'
+  bool rawValue(Common::StringView json, Common::StringView name);
+
+  // Closes the root object on first call, no values can be written after that
+  const std::string& getBuffer();
+
+  friend std::ostream& operator<<(std::ostream& out, JsonOutputBufferSerializer& serializer);
+
+private:
+  struct Level {
+    bool isArray;
+    bool isEmpty;
+  };
+
+  void writeName(Common::StringView name);
+  void writeInteger(int64_t value);
+
+  std::string buffer;
+  std::vector<Level> chain;
+};
+
+}
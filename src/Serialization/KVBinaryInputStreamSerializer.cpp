@@ -17,11 +17,9 @@
 
 #include "KVBinaryInputStreamSerializer.h"
 
-#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <stdexcept>
-#include <Common/StreamTools.h>
 #include "KVBinaryCommon.h"
 
 using namespace Common;
@@ -30,142 +28,183 @@ using namespace CryptoNote;
 namespace {
 
 template <typename T>
-T readPod(Common::IInputStream& s) {
+T readPod(const char* data) {
   T v;
-  read(s, &v, sizeof(T));
+  memcpy(&v, data, sizeof(T));
   return v;
 }
 
-template <typename T, typename JsonT = T>
-JsonValue readPodJson(Common::IInputStream& s) {
-  JsonValue jv;
-  jv = static_cast<JsonT>(readPod<T>(s));
-  return jv;
+size_t valueSize(uint8_t type) {
+  switch (type) {
+  case BIN_KV_SERIALIZE_TYPE_INT64:
+  case BIN_KV_SERIALIZE_TYPE_UINT64:
+  case BIN_KV_SERIALIZE_TYPE_DOUBLE:
+    return 8;
+  case BIN_KV_SERIALIZE_TYPE_INT32:
+  case BIN_KV_SERIALIZE_TYPE_UINT32:
+    return 4;
+  case BIN_KV_SERIALIZE_TYPE_INT16:
+  case BIN_KV_SERIALIZE_TYPE_UINT16:
+    return 2;
+  case BIN_KV_SERIALIZE_TYPE_INT8:
+  case BIN_KV_SERIALIZE_TYPE_UINT8:
+  case BIN_KV_SERIALIZE_TYPE_BOOL:
+    return 1;
+  default:
+    throw std::runtime_error("Unknown data type");
+  }
 }
 
-template <typename T>
-JsonValue readIntegerJson(Common::IInputStream& s) {
-  return readPodJson<T, int64_t>(s);
 }
 
-size_t readVarint(Common::IInputStream& s) {
-  uint8_t b = read<uint8_t>(s);
-  uint8_t size_mask = b & PORTABLE_RAW_SIZE_MARK_MASK;
-  size_t bytesLeft = 0;
-
-  switch (size_mask){
-  case PORTABLE_RAW_SIZE_MARK_BYTE:
-    bytesLeft = 0;
-    break;
-  case PORTABLE_RAW_SIZE_MARK_WORD:
-    bytesLeft = 1;
-    break;
-  case PORTABLE_RAW_SIZE_MARK_DWORD:
-    bytesLeft = 3;
-    break;
-  case PORTABLE_RAW_SIZE_MARK_INT64:
-    bytesLeft = 7;
-    break;
+KVBinaryInputStreamSerializer::KVBinaryInputStreamSerializer(Common::IInputStream& strm) {
+  const size_t CHUNK_SIZE = 4096;
+  for (;;) {
+    size_t size = ownBuffer.size();
+    ownBuffer.resize(size + CHUNK_SIZE);
+    size_t readSize = strm.readSome(&ownBuffer[size], CHUNK_SIZE);
+    ownBuffer.resize(size + readSize);
+    if (readSize == 0) {
+      break;
+    }
   }
 
-  size_t value = b;
+  buffer = Common::StringView(ownBuffer.data(), ownBuffer.size());
+  parse();
+}
 
-  for (size_t i = 1; i <= bytesLeft; ++i) {
-    size_t n = read<uint8_t>(s);
-    value |= n << (i * 8);
-  }
+KVBinaryInputStreamSerializer::KVBinaryInputStreamSerializer(Common::StringView buffer) : buffer(buffer) {
+  parse();
+}
 
-  value >>= 2;
-  return value;
+KVBinaryInputStreamSerializer::~KVBinaryInputStreamSerializer() {
+}
+
+ISerializer::SerializerType KVBinaryInputStreamSerializer::type() const {
+  return ISerializer::INPUT;
 }
 
-std::string readString(Common::IInputStream& s) {
-  auto size = readVarint(s);
-  std::string str;
-  str.resize(size);
-  if (size) {
-    read(s, &str[0], size);
+bool KVBinaryInputStreamSerializer::beginObject(Common::StringView name) {
+  const Entry* entry = getValue(name);
+  if (entry == nullptr) {
+    return false;
+  }
+
+  if (entry->isArray || entry->type != BIN_KV_SERIALIZE_TYPE_OBJECT) {
+    throw std::runtime_error("KV binary value type is not OBJECT");
   }
-  return str;
+
+  size_t index = entry - entries.data();
+  chain.push_back(Level{index, index + 1});
+  return true;
 }
 
-JsonValue readStringJson(Common::IInputStream& s) {
-  return JsonValue(readString(s));
+void KVBinaryInputStreamSerializer::endObject() {
+  assert(chain.size() > 1);
+  chain.pop_back();
 }
 
-void readName(Common::IInputStream& s, std::string& name) {
-  uint8_t len = readPod<uint8_t>(s);
-  if (len) {
-    name.resize(len);
-    read(s, &name[0], len);
+bool KVBinaryInputStreamSerializer::beginArray(size_t& size, Common::StringView name) {
+  const Entry* entry = getValue(name);
+  if (entry == nullptr) {
+    size = 0;
+    return false;
+  }
+
+  if (!entry->isArray) {
+    throw std::runtime_error("KV binary value type is not ARRAY");
   }
+
+  size = entry->count;
+  size_t index = entry - entries.data();
+  chain.push_back(Level{index, index + 1});
+  return true;
 }
 
-JsonValue loadValue(Common::IInputStream& stream, uint8_t type);
-JsonValue loadSection(Common::IInputStream& stream);
-JsonValue loadEntry(Common::IInputStream& stream);
-JsonValue loadArray(Common::IInputStream& stream, uint8_t itemType);
+void KVBinaryInputStreamSerializer::endArray() {
+  assert(chain.size() > 1);
+  chain.pop_back();
+}
 
+bool KVBinaryInputStreamSerializer::operator()(uint8_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
 
-JsonValue loadSection(Common::IInputStream& stream) {
-  JsonValue sec(JsonValue::OBJECT);
-  size_t count = readVarint(stream);
-  std::string name;
+bool KVBinaryInputStreamSerializer::operator()(int16_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
 
-  while (count--) {
-    readName(stream, name);
-    sec.insert(name, loadEntry(stream));
-  }
+bool KVBinaryInputStreamSerializer::operator()(uint16_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
 
-  return sec;
+bool KVBinaryInputStreamSerializer::operator()(int32_t& value, Common::StringView name) {
+  return getNumber(name, value);
 }
 
-JsonValue loadValue(Common::IInputStream& stream, uint8_t type) {
-  switch (type) {
-  case BIN_KV_SERIALIZE_TYPE_INT64:  return readIntegerJson<int64_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_INT32:  return readIntegerJson<int32_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_INT16:  return readIntegerJson<int16_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_INT8:   return readIntegerJson<int8_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_UINT64: return readIntegerJson<uint64_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_UINT32: return readIntegerJson<uint32_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_UINT16: return readIntegerJson<uint16_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_UINT8:  return readIntegerJson<uint8_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_DOUBLE: return readPodJson<double>(stream);
-  case BIN_KV_SERIALIZE_TYPE_BOOL:   return JsonValue(read<uint8_t>(stream) != 0);
-  case BIN_KV_SERIALIZE_TYPE_STRING: return readStringJson(stream);
-  case BIN_KV_SERIALIZE_TYPE_OBJECT: return loadSection(stream);
-  case BIN_KV_SERIALIZE_TYPE_ARRAY:  return loadArray(stream, type);
-  default:
-    throw std::runtime_error("Unknown data type");
-    break;
+bool KVBinaryInputStreamSerializer::operator()(uint32_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(int64_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(uint64_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(double& value, Common::StringView name) {
+  const Entry* entry = getScalar(name, BIN_KV_SERIALIZE_TYPE_DOUBLE);
+  if (entry == nullptr) {
+    return false;
   }
+
+  value = readPod<double>(buffer.getData() + entry->offset);
+  return true;
 }
 
-JsonValue loadEntry(Common::IInputStream& stream) {
-  uint8_t type = readPod<uint8_t>(stream);
+bool KVBinaryInputStreamSerializer::operator()(bool& value, Common::StringView name) {
+  const Entry* entry = getScalar(name, BIN_KV_SERIALIZE_TYPE_BOOL);
+  if (entry == nullptr) {
+    return false;
+  }
+
+  value = buffer.getData()[entry->offset] != 0;
+  return true;
+}
 
-  if (type & BIN_KV_SERIALIZE_FLAG_ARRAY) {
-    type &= ~BIN_KV_SERIALIZE_FLAG_ARRAY;
-    return loadArray(stream, type);
+bool KVBinaryInputStreamSerializer::operator()(std::string& value, Common::StringView name) {
+  const Entry* entry = getScalar(name, BIN_KV_SERIALIZE_TYPE_STRING);
+  if (entry == nullptr) {
+    return false;
   }
 
-  return loadValue(stream, type);
+  value.assign(buffer.getData() + entry->offset, entry->count);
+  return true;
 }
 
-JsonValue loadArray(Common::IInputStream& stream, uint8_t itemType) {
-  JsonValue arr(JsonValue::ARRAY);
-  size_t count = readVarint(stream);
+bool KVBinaryInputStreamSerializer::binary(void* value, size_t size, Common::StringView name) {
+  const Entry* entry = getScalar(name, BIN_KV_SERIALIZE_TYPE_STRING);
+  if (entry == nullptr) {
+    return false;
+  }
 
-  while (count--) {
-    arr.pushBack(loadValue(stream, itemType));
+  if (entry->count != size) {
+    throw std::runtime_error("Binary block size mismatch");
   }
 
-  return arr;
+  memcpy(value, buffer.getData() + entry->offset, size);
+  return true;
 }
 
+bool KVBinaryInputStreamSerializer::binary(std::string& value, Common::StringView name) {
+  return (*this)(value, name); // load as string
+}
 
-JsonValue parseBinary(Common::IInputStream& stream) {
-  auto hdr = readPod<KVBinaryStorageBlockHeader>(stream);
+void KVBinaryInputStreamSerializer::parse() {
+  position = 0;
+  auto hdr = readPod<KVBinaryStorageBlockHeader>(take(sizeof(KVBinaryStorageBlockHeader)));
 
   if (
     hdr.m_signature_a != PORTABLE_STORAGE_SIGNATUREA ||
@@ -177,30 +216,190 @@ JsonValue parseBinary(Common::IInputStream& stream) {
     throw std::runtime_error("Unknown binary storage format version");
   }
 
-  return loadSection(stream);
+  entries.push_back(Entry{BIN_KV_SERIALIZE_TYPE_OBJECT, false, 0, 0, position, 0, 0});
+  parseSection(0);
+  entries[0].next = entries.size();
+  chain.push_back(Level{0, 1});
 }
 
+void KVBinaryInputStreamSerializer::parseSection(size_t index) {
+  size_t count = readVarint();
+  entries[index].count = count;
+
+  while (count--) {
+    size_t child = entries.size();
+    entries.push_back(Entry{0, false, 0, 0, 0, 0, 0});
+
+    uint8_t nameSize = static_cast<uint8_t>(*take(1));
+    entries[child].nameOffset = position;
+    entries[child].nameSize = nameSize;
+    take(nameSize);
+
+    uint8_t type = static_cast<uint8_t>(*take(1));
+    if (type & BIN_KV_SERIALIZE_FLAG_ARRAY) {
+      entries[child].type = type & ~BIN_KV_SERIALIZE_FLAG_ARRAY;
+      entries[child].isArray = true;
+      parseArray(child);
+    } else {
+      entries[child].type = type;
+      parseValue(child);
+    }
+
+    entries[child].next = entries.size();
+  }
 }
 
-KVBinaryInputStreamSerializer::KVBinaryInputStreamSerializer(Common::IInputStream& strm) : JsonInputValueSerializer(parseBinary(strm)) {
+void KVBinaryInputStreamSerializer::parseArray(size_t index) {
+  size_t count = readVarint();
+  entries[index].count = count;
+  entries[index].offset = position;
+  uint8_t itemType = entries[index].type;
+
+  // every element takes at least one byte, so a bogus count runs out of data instead of memory
+  while (count--) {
+    size_t child = entries.size();
+    entries.push_back(Entry{itemType, false, 0, 0, 0, 0, 0});
+    parseValue(child);
+    entries[child].next = entries.size();
+  }
 }
 
-bool KVBinaryInputStreamSerializer::binary(void* value, size_t size, Common::StringView name) {
-  std::string str;
+void KVBinaryInputStreamSerializer::parseValue(size_t index) {
+  entries[index].offset = position;
 
-  if (!(*this)(str, name)) {
-    return false;
+  switch (entries[index].type) {
+  case BIN_KV_SERIALIZE_TYPE_STRING:
+    entries[index].count = readVarint();
+    entries[index].offset = position;
+    take(entries[index].count);
+    break;
+  case BIN_KV_SERIALIZE_TYPE_OBJECT:
+    parseSection(index);
+    break;
+  case BIN_KV_SERIALIZE_TYPE_ARRAY: {
+    uint8_t type = static_cast<uint8_t>(*take(1));
+    if ((type & BIN_KV_SERIALIZE_FLAG_ARRAY) == 0) {
+      throw std::runtime_error("Array item is expected to be an array");
+    }
+
+    entries[index].type = type & ~BIN_KV_SERIALIZE_FLAG_ARRAY;
+    entries[index].isArray = true;
+    parseArray(index);
+    break;
+  }
+  default:
+    take(valueSize(entries[index].type));
+    break;
   }
+}
 
-  if (str.size() != size) {
-    throw std::runtime_error("Binary block size mismatch");
+size_t KVBinaryInputStreamSerializer::readVarint() {
+  uint8_t b = static_cast<uint8_t>(*take(1));
+  uint8_t size_mask = b & PORTABLE_RAW_SIZE_MARK_MASK;
+  size_t bytesLeft = 0;
+
+  switch (size_mask){
+  case PORTABLE_RAW_SIZE_MARK_BYTE:
+    bytesLeft = 0;
+    break;
+  case PORTABLE_RAW_SIZE_MARK_WORD:
+    bytesLeft = 1;
+    break;
+  case PORTABLE_RAW_SIZE_MARK_DWORD:
+    bytesLeft = 3;
+    break;
+  case PORTABLE_RAW_SIZE_MARK_INT64:
+    bytesLeft = 7;
+    break;
   }
 
-  memcpy(value, str.data(), size);
-  return true;
+  size_t value = b;
+  const char* data = take(bytesLeft);
+
+  for (size_t i = 1; i <= bytesLeft; ++i) {
+    size_t n = static_cast<uint8_t>(data[i - 1]);
+    value |= n << (i * 8);
+  }
+
+  value >>= 2;
+  return value;
 }
 
-bool KVBinaryInputStreamSerializer::binary(std::string& value, Common::StringView name) {
-  return (*this)(value, name); // load as string
+const char* KVBinaryInputStreamSerializer::take(size_t size) {
+  if (size > buffer.getSize() - position) {
+    throw std::runtime_error("Unexpected end of KV binary data");
+  }
+
+  const char* data = buffer.getData() + position;
+  position += size;
+  return data;
 }
 
+const KVBinaryInputStreamSerializer::Entry* KVBinaryInputStreamSerializer::getValue(Common::StringView name) {
+  assert(!chain.empty());
+  Level& level = chain.back();
+  const Entry& parent = entries[level.entry];
+  if (parent.isArray) {
+    if (level.cursor == parent.next) {
+      throw std::runtime_error("KV binary array index is out of range");
+    }
+
+    const Entry* entry = &entries[level.cursor];
+    level.cursor = entry->next;
+    return entry;
+  }
+
+  return findMember(level, name);
+}
+
+// Members are usually read in the order they were written, so the lookup starts right after the previous match
+const KVBinaryInputStreamSerializer::Entry* KVBinaryInputStreamSerializer::findMember(Level& level, Common::StringView name) {
+  const Entry& parent = entries[level.entry];
+  const char* data = buffer.getData();
+
+  for (size_t pass = 0; pass < 2; ++pass) {
+    size_t index = pass == 0 ? level.cursor : level.entry + 1;
+    size_t last = pass == 0 ? parent.next : level.cursor;
+    while (index < last) {
+      const Entry& entry = entries[index];
+      if (entry.nameSize == name.getSize() && memcmp(data + entry.nameOffset, name.getData(), entry.nameSize) == 0) {
+        level.cursor = entry.next;
+        return &entry;
+      }
+
+      index = entry.next;
+    }
+  }
+
+  return nullptr;
+}
+
+const KVBinaryInputStreamSerializer::Entry* KVBinaryInputStreamSerializer::getScalar(Common::StringView name, uint8_t type) {
+  const Entry* entry = getValue(name);
+  if (entry != nullptr && (entry->isArray || entry->type != type)) {
+    throw std::runtime_error("KV binary value type mismatch");
+  }
+
+  return entry;
+}
+
+int64_t KVBinaryInputStreamSerializer::getInteger(const Entry& entry) const {
+  const char* data = buffer.getData() + entry.offset;
+
+  if (!entry.isArray) {
+    switch (entry.type) {
+    case BIN_KV_SERIALIZE_TYPE_INT64:  return readPod<int64_t>(data);
+    case BIN_KV_SERIALIZE_TYPE_INT32:  return readPod<int32_t>(data);
+    case BIN_KV_SERIALIZE_TYPE_INT16:  return readPod<int16_t>(data);
+    case BIN_KV_SERIALIZE_TYPE_INT8:   return readPod<int8_t>(data);
+    case BIN_KV_SERIALIZE_TYPE_UINT64: return static_cast<int64_t>(readPod<uint64_t>(data));
+    case BIN_KV_SERIALIZE_TYPE_UINT32: return readPod<uint32_t>(data);
+    case BIN_KV_SERIALIZE_TYPE_UINT16: return readPod<uint16_t>(data);
+    case BIN_KV_SERIALIZE_TYPE_UINT8:  return readPod<uint8_t>(data);
+    default:
+      break;
+    }
+  }
+
+  throw std::runtime_error("KV binary value type is not INTEGER");
+}
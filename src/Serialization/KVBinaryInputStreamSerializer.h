@@ -17,18 +17,94 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
 #include <Common/IInputStream.h>
 #include "ISerializer.h"
-#include "JsonInputValueSerializer.h"
 
 namespace CryptoNote {
 
-class KVBinaryInputStreamSerializer : public JsonInputValueSerializer {
+// Reads KV binary storage from a contiguous buffer without building a JsonValue tree.
+// The buffer is walked once to index entries, values are decoded only when requested.
+class KVBinaryInputStreamSerializer : public ISerializer {
 public:
   KVBinaryInputStreamSerializer(Common::IInputStream& strm);
+  KVBinaryInputStreamSerializer(Common::StringView buffer);
+  KVBinaryInputStreamSerializer(const KVBinaryInputStreamSerializer&) = delete;
+  virtual ~KVBinaryInputStreamSerializer();
 
+  SerializerType type() const override;
+
+  virtual bool beginObject(Common::StringView name) override;
+  virtual void endObject() override;
+
+  virtual bool beginArray(size_t& size, Common::StringView name) override;
+  virtual void endArray() override;
+
+  virtual bool operator()(uint8_t& value, Common::StringView name) override;
+  virtual bool operator()(int16_t& value, Common::StringView name) override;
+  virtual bool operator()(uint16_t& value, Common::StringView name) override;
+  virtual bool operator()(int32_t& value, Common::StringView name) override;
+  virtual bool operator()(uint32_t& value, Common::StringView name) override;
+  virtual bool operator()(int64_t& value, Common::StringView name) override;
+  virtual bool operator()(uint64_t& value, Common::StringView name) override;
+  virtual bool operator()(double& value, Common::StringView name) override;
+  virtual bool operator()(bool& value, Common::StringView name) override;
+  virtual bool operator()(std::string& value, Common::StringView name) override;
   virtual bool binary(void* value, size_t size, Common::StringView name) override;
   virtual bool binary(std::string& value, Common::StringView name) override;
+
+  template<typename T>
+  bool operator()(T& value, Common::StringView name) {
+    return ISerializer::operator()(value, name);
+  }
+
+private:
+  struct Entry {
+    uint8_t type;
+    bool isArray;
+    uint8_t nameSize;
+    size_t nameOffset;
+    size_t offset; // value data
+    size_t count; // string length, members of section or elements of array
+    size_t next; // index of the entry following the whole value
+  };
+
+  struct Level {
+    size_t entry;
+    size_t cursor; // next array element or member to start lookup from
+  };
+
+  void parse();
+  void parseSection(size_t index);
+  void parseArray(size_t index);
+  void parseValue(size_t index);
+  size_t readVarint();
+  const char* take(size_t size);
+
+  const Entry* getValue(Common::StringView name);
+  const Entry* findMember(Level& level, Common::StringView name);
+  const Entry* getScalar(Common::StringView name, uint8_t type);
+
+  template <typename T>
+  bool getNumber(Common::StringView name, T& v) {
+    auto ptr = getValue(name);
+
+    if (!ptr) {
+      return false;
+    }
+
+    v = static_cast<T>(getInteger(*ptr));
+    return true;
+  }
+
+  int64_t getInteger(const Entry& entry) const;
+
+  std::string ownBuffer;
+  Common::StringView buffer;
+  size_t position;
+  std::vector<Entry> entries;
+  std::vector<Level> chain;
 };
 
 }
@@ -19,6 +19,8 @@
 #include "KVBinaryCommon.h"
 
 #include <cassert>
+#include <cstring>
+#include <limits>
 #include <stdexcept>
 #include <Common/StreamTools.h>
 
@@ -27,30 +29,15 @@ using namespace CryptoNote;
 
 namespace {
 
-template <typename T>
-void writePod(IOutputStream& s, const T& value) {
-  write(s, &value, sizeof(T));
-}
-
 template<class T>
-size_t packVarint(IOutputStream& s, uint8_t type_or, size_t pv) {
+size_t packVarint(char* s, uint8_t type_or, size_t pv) {
   T v = static_cast<T>(pv << 2);
   v |= type_or;
-  write(s, &v, sizeof(T));
+  memcpy(s, &v, sizeof(T));
   return sizeof(T);
 }
 
-void writeElementName(IOutputStream& s, Common::StringView name) {
-  if (name.getSize() > std::numeric_limits<uint8_t>::max()) {
-    throw std::runtime_error("Element name is too long");
-  }
-
-  uint8_t len = static_cast<uint8_t>(name.getSize());
-  write(s, &len, sizeof(len));
-  write(s, name.getData(), len);
-}
-
-size_t writeArraySize(IOutputStream& s, size_t val) {
+size_t packArraySize(char* s, size_t val) {
   if (val <= 63) {
     return packVarint<uint8_t>(s, PORTABLE_RAW_SIZE_MARK_BYTE, val);
   } else if (val <= 16383) {
@@ -65,16 +52,24 @@ size_t writeArraySize(IOutputStream& s, size_t val) {
   }
 }
 
+void writeElementName(std::string& s, Common::StringView name) {
+  if (name.getSize() > std::numeric_limits<uint8_t>::max()) {
+    throw std::runtime_error("Element name is too long");
+  }
+
+  s.push_back(static_cast<char>(name.getSize()));
+  s.append(name.getData(), name.getSize());
+}
+
 }
 
 namespace CryptoNote {
 
 KVBinaryOutputStreamSerializer::KVBinaryOutputStreamSerializer() {
-  beginObject(std::string());
+  m_stack.push_back(Level(std::string(), 0));
 }
 
 void KVBinaryOutputStreamSerializer::dump(IOutputStream& target) {
-  assert(m_objectsStack.size() == 1);
   assert(m_stack.size() == 1);
 
   KVBinaryStorageBlockHeader hdr;
@@ -82,9 +77,24 @@ void KVBinaryOutputStreamSerializer::dump(IOutputStream& target) {
   hdr.m_signature_b = PORTABLE_STORAGE_SIGNATUREB;
   hdr.m_ver = PORTABLE_STORAGE_FORMAT_VER;
 
+  char size[sizeof(uint64_t)];
   Common::write(target, &hdr, sizeof(hdr));
-  writeArraySize(target, m_stack.front().count);
-  write(target, stream().data(), stream().size());
+  Common::write(target, size, packArraySize(size, m_stack.front().count));
+  Common::write(target, m_buffer.data(), m_buffer.size());
+}
+
+std::string KVBinaryOutputStreamSerializer::getSection() const {
+  assert(m_stack.size() == 1);
+
+  char size[sizeof(uint64_t)];
+  std::string section(size, packArraySize(size, m_stack.front().count));
+  section.append(m_buffer);
+  return section;
+}
+
+void KVBinaryOutputStreamSerializer::writeSection(const std::string& section, Common::StringView name) {
+  writeElementPrefix(BIN_KV_SERIALIZE_TYPE_OBJECT, name);
+  m_buffer.append(section);
 }
 
 ISerializer::SerializerType KVBinaryOutputStreamSerializer::type() const {
@@ -92,33 +102,26 @@ ISerializer::SerializerType KVBinaryOutputStreamSerializer::type() const {
 }
 
 bool KVBinaryOutputStreamSerializer::beginObject(Common::StringView name) {
-  checkArrayPreamble(BIN_KV_SERIALIZE_TYPE_OBJECT);
- 
-  m_stack.push_back(Level(name));
-  m_objectsStack.push_back(MemoryStream());
+  writeElementPrefix(BIN_KV_SERIALIZE_TYPE_OBJECT, name);
+
+  // most sections have less than 64 members, so a single byte is reserved for the member count
+  m_stack.push_back(Level(name, m_buffer.size()));
+  m_buffer.push_back(0);
 
   return true;
 }
 
 void KVBinaryOutputStreamSerializer::endObject() {
-  assert(m_objectsStack.size());
+  assert(m_stack.size() > 1);
 
   auto level = std::move(m_stack.back());
   m_stack.pop_back();
 
-  auto objStream = std::move(m_objectsStack.back());
-  m_objectsStack.pop_back();
-
-  auto& out = stream();
-
-  writeElementPrefix(BIN_KV_SERIALIZE_TYPE_OBJECT, level.name);
-
-  writeArraySize(out, level.count);
-  write(out, objStream.data(), objStream.size());
+  patchArraySize(level.sizeOffset, level.count);
 }
 
 bool KVBinaryOutputStreamSerializer::beginArray(size_t& size, Common::StringView name) {
-  m_stack.push_back(Level(name, size));
+  m_stack.push_back(Level(name, size, m_buffer.size()));
   return true;
 }
 
@@ -133,73 +136,71 @@ void KVBinaryOutputStreamSerializer::endArray() {
 
 bool KVBinaryOutputStreamSerializer::operator()(uint8_t& value, Common::StringView name) {
   writeElementPrefix(BIN_KV_SERIALIZE_TYPE_UINT8, name);
-  writePod(stream(), value);
+  writePod(value);
   return true;
 }
 
 bool KVBinaryOutputStreamSerializer::operator()(uint16_t& value, Common::StringView name) {
   writeElementPrefix(BIN_KV_SERIALIZE_TYPE_UINT16, name);
-  writePod(stream(), value);
+  writePod(value);
   return true;
 }
 
 bool KVBinaryOutputStreamSerializer::operator()(int16_t& value, Common::StringView name) {
   writeElementPrefix(BIN_KV_SERIALIZE_TYPE_INT16, name);
-  writePod(stream(), value);
+  writePod(value);
   return true;
 }
 
 bool KVBinaryOutputStreamSerializer::operator()(uint32_t& value, Common::StringView name) {
   writeElementPrefix(BIN_KV_SERIALIZE_TYPE_UINT32, name);
-  writePod(stream(), value);
+  writePod(value);
   return true;
 }
 
 bool KVBinaryOutputStreamSerializer::operator()(int32_t& value, Common::StringView name) {
   writeElementPrefix(BIN_KV_SERIALIZE_TYPE_INT32, name);
-  writePod(stream(), value);
+  writePod(value);
   return true;
 }
 
 bool KVBinaryOutputStreamSerializer::operator()(int64_t& value, Common::StringView name) {
   writeElementPrefix(BIN_KV_SERIALIZE_TYPE_INT64, name);
-  writePod(stream(), value);
+  writePod(value);
   return true;
 }
 
 bool KVBinaryOutputStreamSerializer::operator()(uint64_t& value, Common::StringView name) {
   writeElementPrefix(BIN_KV_SERIALIZE_TYPE_UINT64, name);
-  writePod(stream(), value);
+  writePod(value);
   return true;
 }
 
 bool KVBinaryOutputStreamSerializer::operator()(bool& value, Common::StringView name) {
   writeElementPrefix(BIN_KV_SERIALIZE_TYPE_BOOL, name);
-  writePod(stream(), value);
+  writePod(value);
   return true;
 }
 
 bool KVBinaryOutputStreamSerializer::operator()(double& value, Common::StringView name) {
   writeElementPrefix(BIN_KV_SERIALIZE_TYPE_DOUBLE, name);
-  writePod(stream(), value);
+  writePod(value);
   return true;
 }
 
 bool KVBinaryOutputStreamSerializer::operator()(std::string& value, Common::StringView name) {
   writeElementPrefix(BIN_KV_SERIALIZE_TYPE_STRING, name);
 
-  auto& out = stream();
-  writeArraySize(out, value.size());
-  write(out, value.data(), value.size());
+  writeArraySize(value.size());
+  m_buffer.append(value);
   return true;
 }
 
 bool KVBinaryOutputStreamSerializer::binary(void* value, size_t size, Common::StringView name) {
   if (size > 0) {
     writeElementPrefix(BIN_KV_SERIALIZE_TYPE_STRING, name);
-    auto& out = stream();
-    writeArraySize(out, size);
-    write(out, value, size);
+    writeArraySize(size);
+    m_buffer.append(static_cast<const char*>(value), size);
   }
   return true;
 }
@@ -216,9 +217,8 @@ void KVBinaryOutputStreamSerializer::writeElementPrefix(uint8_t type, Common::St
   
   if (level.state != State::Array) {
     if (!name.isEmpty()) {
-      auto& s = stream();
-      writeElementName(s, name);
-      write(s, &type, 1);
+      writeElementName(m_buffer, name);
+      m_buffer.push_back(static_cast<char>(type));
     }
     ++level.count;
   }
@@ -232,19 +232,28 @@ void KVBinaryOutputStreamSerializer::checkArrayPreamble(uint8_t type) {
   Level& level = m_stack.back();
 
   if (level.state == State::ArrayPrefix) {
-    auto& s = stream();
-    writeElementName(s, level.name);
-    char c = BIN_KV_SERIALIZE_FLAG_ARRAY | type;
-    write(s, &c, 1);
-    writeArraySize(s, level.count);
+    writeElementName(m_buffer, level.name);
+    m_buffer.push_back(static_cast<char>(BIN_KV_SERIALIZE_FLAG_ARRAY | type));
+    writeArraySize(level.count);
     level.state = State::Array;
   }
 }
 
+void KVBinaryOutputStreamSerializer::writeArraySize(size_t size) {
+  char packed[sizeof(uint64_t)];
+  m_buffer.append(packed, packArraySize(packed, size));
+}
+
+void KVBinaryOutputStreamSerializer::patchArraySize(size_t offset, size_t size) {
+  char packed[sizeof(uint64_t)];
+  size_t packedSize = packArraySize(packed, size);
+
+  // the section is always the tail of the buffer, so growing the reserved byte moves only its own content
+  if (packedSize > 1) {
+    m_buffer.insert(offset + 1, packedSize - 1, '\0');
+  }
 
-MemoryStream& KVBinaryOutputStreamSerializer::stream() {
-  assert(m_objectsStack.size());
-  return m_objectsStack.back();
+  memcpy(&m_buffer[offset], packed, packedSize);
 }
 
 }
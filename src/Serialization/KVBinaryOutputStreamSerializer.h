@@ -17,13 +17,15 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 #include <Common/IOutputStream.h>
 #include "ISerializer.h"
-#include "MemoryStream.h"
 
 namespace CryptoNote {
 
+// Writes KV binary storage into a single contiguous buffer.
+// Section sizes are reserved when a section begins and patched when it ends.
 class KVBinaryOutputStreamSerializer : public ISerializer {
 public:
 
@@ -32,6 +34,11 @@ public:
 
   void dump(Common::IOutputStream& target);
 
+  // Returns the root section without the storage header, so it can be embedded with writeSection()
+  std::string getSection() const;
+  // Writes an object member or array element whose content was produced by getSection()
+  void writeSection(const std::string& section, Common::StringView name);
+
   virtual ISerializer::SerializerType type() const override;
 
   virtual bool beginObject(Common::StringView name) override;
@@ -62,8 +69,13 @@ private:
 
   void writeElementPrefix(uint8_t type, Common::StringView name);
   void checkArrayPreamble(uint8_t type);
-  void updateState(uint8_t type);
-  MemoryStream& stream();
+  void writeArraySize(size_t size);
+  void patchArraySize(size_t offset, size_t size);
+
+  template <typename T>
+  void writePod(const T& value) {
+    m_buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
 
   enum class State {
     Root,
@@ -76,22 +88,24 @@ private:
     State state;
     std::string name;
     size_t count;
+    size_t sizeOffset; // position of the reserved section size in the buffer
 
-    Level(Common::StringView nm) :
-      name(nm), state(State::Object), count(0) {}
+    Level(Common::StringView nm, size_t offset) :
+      name(nm), state(State::Object), count(0), sizeOffset(offset) {}
 
-    Level(Common::StringView nm, size_t arraySize) :
-      name(nm), state(State::ArrayPrefix), count(arraySize) {}
+    Level(Common::StringView nm, size_t arraySize, size_t offset) :
+      name(nm), state(State::ArrayPrefix), count(arraySize), sizeOffset(offset) {}
 
     Level(Level&& rv) {
       state = rv.state;
       name = std::move(rv.name);
       count = rv.count;
+      sizeOffset = rv.sizeOffset;
     }
 
   };
 
-  std::vector<MemoryStream> m_objectsStack;
+  std::string m_buffer;
   std::vector<Level> m_stack;
 };
 
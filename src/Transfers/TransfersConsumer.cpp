@@ -159,6 +159,58 @@ void TransfersConsumer::getSubscriptions(std::vector<AccountPublicAddress>& subs
   }
 }
 
+bool TransfersConsumer::moveSubscription(const AccountPublicAddress& address, TransfersConsumer& consumer) {
+  assert(consumer.m_viewSecret == m_viewSecret);
+
+  auto it = m_subscriptions.find(address.spendPublicKey);
+  if (it == m_subscriptions.end()) {
+    return false;
+  }
+
+  auto& target = consumer.m_subscriptions[address.spendPublicKey];
+  assert(target.get() == nullptr);
+  target = std::move(it->second);
+  consumer.m_spendKeys.insert(address.spendPublicKey);
+  consumer.updateSyncStart();
+
+  m_subscriptions.erase(it);
+  m_spendKeys.erase(address.spendPublicKey);
+  updateSyncStart();
+
+  return true;
+}
+
+void TransfersConsumer::merge(TransfersConsumer& consumer) {
+  std::vector<AccountPublicAddress> addresses;
+  consumer.getSubscriptions(addresses);
+  for (const auto& address : addresses) {
+    consumer.moveSubscription(address, *this);
+  }
+
+  m_poolTxs.insert(consumer.m_poolTxs.begin(), consumer.m_poolTxs.end());
+  consumer.m_poolTxs.clear();
+}
+
+void TransfersConsumer::getTransactionContainers(const Crypto::Hash& transactionHash, std::vector<ITransfersContainer*>& containers) {
+  TransactionInformation info;
+  for (const auto& kv : m_subscriptions) {
+    auto& container = kv.second->getContainer();
+    if (container.getTransactionInformation(transactionHash, info)) {
+      containers.push_back(&container);
+    }
+  }
+}
+
+const Crypto::SecretKey& TransfersConsumer::getViewSecretKey() const {
+  return m_viewSecret;
+}
+
+void TransfersConsumer::advanceHeight(uint32_t height) {
+  forEachSubscription([height](TransfersSubscription& sub) {
+    sub.advanceHeight(height);
+  });
+}
+
 void TransfersConsumer::initTransactionPool(const std::unordered_set<Crypto::Hash>& uncommitedTransactions) {
   for (auto itSubscriptions = m_subscriptions.begin(); itSubscriptions != m_subscriptions.end(); ++itSubscriptions) {
     std::vector<Crypto::Hash> unconfirmedTransactions;
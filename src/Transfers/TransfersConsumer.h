@@ -43,6 +43,14 @@ public:
   bool removeSubscription(const AccountPublicAddress& address);
   ITransfersSubscription* getSubscription(const AccountPublicAddress& acc);
   void getSubscriptions(std::vector<AccountPublicAddress>& subscriptions);
+  // moves the subscription with its container to another consumer of the same view key
+  bool moveSubscription(const AccountPublicAddress& address, TransfersConsumer& consumer);
+  // takes over all subscriptions and known pool transactions of a consumer that has reached the same block
+  void merge(TransfersConsumer& consumer);
+  void getTransactionContainers(const Crypto::Hash& transactionHash, std::vector<ITransfersContainer*>& containers);
+  const Crypto::SecretKey& getViewSecretKey() const;
+  // moves containers of all subscriptions to the block index, when a saved synchronization state is applied
+  void advanceHeight(uint32_t height);
 
   void initTransactionPool(const std::unordered_set<Crypto::Hash>& uncommitedTransactions);
   
@@ -150,6 +150,9 @@ size_t SpentOutputDescriptor::hash() const {
 
 
 TransfersContainer::TransfersContainer(const Currency& currency, Logging::ILogger& logger, size_t transactionSpendableAge) :
+  m_lockedBalance(0),
+  m_softLockedBalance(0),
+  m_unlockedBalance(0),
   m_currentHeight(0),
   m_currency(currency),
   m_logger(logger, "TransfersContainer"),
@@ -182,7 +185,7 @@ bool TransfersContainer::addTransaction(const TransactionBlockInfo& block, const
     }
 
     if (block.height != WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT) {
-      m_currentHeight = block.height;
+      setCurrentHeight(block.height);
     }
 
     return added;
@@ -598,6 +601,7 @@ std::vector<Hash> TransfersContainer::detach(uint32_t height) {
 
   // TODO: notification on detach
   m_currentHeight = height == 0 ? 0 : height - 1;
+  rebuildBalance();
 
   return deletedTransactions;
 }
@@ -631,6 +635,8 @@ void TransfersContainer::updateTransfersVisibility(const KeyImage& keyImage) {
   size_t spentCount = std::distance(spentRange.first, spentRange.second);
   assert(spentCount == 0 || spentCount == 1);
 
+  removeBalanceEntry(keyImage);
+
   if (spentCount > 0) {
     updateVisibility(unconfirmedIndex, unconfirmedRange, false);
     updateVisibility(availableIndex, availableRange, false);
@@ -646,8 +652,182 @@ void TransfersContainer::updateTransfersVisibility(const KeyImage& keyImage) {
     auto earliestTransfer = *earliestTransferIt;
     earliestTransfer.visible = true;
     availableIndex.replace(earliestTransferIt, earliestTransfer);
+    addBalanceEntry(keyImage, earliestTransfer);
   } else {
     updateVisibility(unconfirmedIndex, unconfirmedRange, unconfirmedCount == 1);
+    if (unconfirmedCount == 1) {
+      addBalanceEntry(keyImage, *unconfirmedRange.first);
+    }
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::setCurrentHeight(uint32_t height) {
+  if (height < m_currentHeight) {
+    m_currentHeight = height;
+    rebuildBalance();
+    return;
+  }
+
+  m_currentHeight = height;
+
+  auto jobsEnd = m_heightUnlockJobs.upper_bound(height);
+  for (auto it = m_heightUnlockJobs.begin(); it != jobsEnd; ++it) {
+    auto entryIt = m_balanceEntries.find(it->second);
+    assert(entryIt != m_balanceEntries.end());
+
+    auto& entry = entryIt->second;
+    uint32_t state = getBalanceState(entry, height);
+    if (state != entry.state) {
+      getBalance(entry.state) -= entry.amount;
+      getBalance(state) += entry.amount;
+      entry.state = state;
+    }
+  }
+
+  m_heightUnlockJobs.erase(m_heightUnlockJobs.begin(), jobsEnd);
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::addBalanceEntry(const KeyImage& keyImage, const TransactionOutputInformationEx& transfer) {
+  assert(transfer.visible);
+  assert(m_balanceEntries.count(keyImage) == 0);
+
+  BalanceEntry entry;
+  entry.amount = transfer.amount;
+  entry.unlockTime = transfer.unlockTime;
+  entry.blockHeight = transfer.blockHeight;
+  entry.timeLocked = false;
+
+  if (transfer.blockHeight != WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT) {
+    if (transfer.unlockTime >= m_currency.maxBlockHeight()) {
+      if (!isSpendTimeUnlocked(transfer.unlockTime)) {
+        entry.timeLocked = true;
+        m_timeUnlockJobs.emplace(transfer.unlockTime - m_currency.lockedTxAllowedDeltaSeconds(), keyImage);
+      }
+    } else if (transfer.unlockTime > m_currentHeight + m_currency.lockedTxAllowedDeltaBlocks()) {
+      m_heightUnlockJobs.emplace(transfer.unlockTime - m_currency.lockedTxAllowedDeltaBlocks(), keyImage);
+    }
+
+    if (transfer.blockHeight + m_transactionSpendableAge > m_currentHeight) {
+      m_heightUnlockJobs.emplace(transfer.blockHeight + m_transactionSpendableAge, keyImage);
+    }
+  }
+
+  entry.state = getBalanceState(entry, m_currentHeight);
+  getBalance(entry.state) += entry.amount;
+  m_balanceEntries.emplace(keyImage, entry);
+}
+
+namespace {
+  void eraseUnlockJob(std::multimap<uint64_t, KeyImage>& jobs, uint64_t unlockAt, const KeyImage& keyImage) {
+    auto range = jobs.equal_range(unlockAt);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == keyImage) {
+        jobs.erase(it);
+        break;
+      }
+    }
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::removeBalanceEntry(const KeyImage& keyImage) {
+  auto it = m_balanceEntries.find(keyImage);
+  if (it == m_balanceEntries.end()) {
+    return;
+  }
+
+  const auto& entry = it->second;
+  getBalance(entry.state) -= entry.amount;
+
+  if (entry.blockHeight != WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT) {
+    if (entry.timeLocked) {
+      eraseUnlockJob(m_timeUnlockJobs, entry.unlockTime - m_currency.lockedTxAllowedDeltaSeconds(), keyImage);
+    } else if (entry.unlockTime < m_currency.maxBlockHeight() && entry.unlockTime > m_currentHeight + m_currency.lockedTxAllowedDeltaBlocks()) {
+      eraseUnlockJob(m_heightUnlockJobs, entry.unlockTime - m_currency.lockedTxAllowedDeltaBlocks(), keyImage);
+    }
+
+    if (entry.blockHeight + m_transactionSpendableAge > m_currentHeight) {
+      eraseUnlockJob(m_heightUnlockJobs, entry.blockHeight + m_transactionSpendableAge, keyImage);
+    }
+  }
+
+  m_balanceEntries.erase(it);
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::rebuildBalance() {
+  m_balanceEntries.clear();
+  m_heightUnlockJobs.clear();
+  m_timeUnlockJobs.clear();
+  m_lockedBalance = 0;
+  m_softLockedBalance = 0;
+  m_unlockedBalance = 0;
+
+  for (const auto& t : m_unconfirmedTransfers) {
+    if (t.visible && t.type == TransactionTypes::OutputType::Key && m_balanceEntries.count(t.keyImage) == 0) {
+      addBalanceEntry(t.keyImage, t);
+    }
+  }
+
+  for (const auto& t : m_availableTransfers) {
+    if (t.visible && t.type == TransactionTypes::OutputType::Key && m_balanceEntries.count(t.keyImage) == 0) {
+      addBalanceEntry(t.keyImage, t);
+    }
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::processTimeUnlockJobs() const {
+  uint64_t currentTime = static_cast<uint64_t>(time(nullptr));
+
+  auto jobsEnd = m_timeUnlockJobs.upper_bound(currentTime);
+  for (auto it = m_timeUnlockJobs.begin(); it != jobsEnd; ++it) {
+    auto entryIt = m_balanceEntries.find(it->second);
+    assert(entryIt != m_balanceEntries.end());
+
+    auto& entry = entryIt->second;
+    entry.timeLocked = false;
+    uint32_t state = getBalanceState(entry, m_currentHeight);
+    getBalance(entry.state) -= entry.amount;
+    getBalance(state) += entry.amount;
+    entry.state = state;
+  }
+
+  m_timeUnlockJobs.erase(m_timeUnlockJobs.begin(), jobsEnd);
+}
+
+uint32_t TransfersContainer::getBalanceState(const BalanceEntry& entry, uint32_t height) const {
+  if (entry.blockHeight == WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT || entry.timeLocked ||
+      (entry.unlockTime < m_currency.maxBlockHeight() && height + m_currency.lockedTxAllowedDeltaBlocks() < entry.unlockTime)) {
+    return IncludeStateLocked;
+  } else if (height < entry.blockHeight + m_transactionSpendableAge) {
+    return IncludeStateSoftLocked;
+  } else {
+    return IncludeStateUnlocked;
+  }
+}
+
+uint64_t& TransfersContainer::getBalance(uint32_t state) const {
+  switch (state) {
+  case IncludeStateLocked:
+    return m_lockedBalance;
+  case IncludeStateSoftLocked:
+    return m_softLockedBalance;
+  default:
+    assert(state == IncludeStateUnlocked);
+    return m_unlockedBalance;
   }
 }
 
@@ -655,7 +835,7 @@ bool TransfersContainer::advanceHeight(uint32_t height) {
   std::lock_guard<std::mutex> lk(m_mutex);
 
   if (m_currentHeight <= height) {
-    m_currentHeight = height;
+    setCurrentHeight(height);
     return true;
   }
 
@@ -674,20 +854,25 @@ size_t TransfersContainer::transactionsCount() const {
 
 uint64_t TransfersContainer::balance(uint32_t flags) const {
   std::lock_guard<std::mutex> lk(m_mutex);
-  uint64_t amount = 0;
 
-  for (const auto& t : m_availableTransfers) {
-    if (t.visible && isIncluded(t, flags)) {
-      amount += t.amount;
-    }
+  // only key outputs are counted
+  if ((flags & IncludeTypeKey) == 0) {
+    return 0;
   }
 
+  processTimeUnlockJobs();
+
+  uint64_t amount = 0;
   if ((flags & IncludeStateLocked) != 0) {
-    for (const auto& t : m_unconfirmedTransfers) {
-      if (t.visible && isIncluded(t.type, IncludeStateLocked, flags)) {
-        amount += t.amount;
-      }
-    }
+    amount += m_lockedBalance;
+  }
+
+  if ((flags & IncludeStateSoftLocked) != 0) {
+    amount += m_softLockedBalance;
+  }
+
+  if ((flags & IncludeStateUnlocked) != 0) {
+    amount += m_unlockedBalance;
   }
 
   return amount;
@@ -882,6 +1067,7 @@ void TransfersContainer::load(std::istream& in) {
   m_unconfirmedTransfers = std::move(unconfirmedTransfers);
   m_availableTransfers = std::move(availableTransfers);
   m_spentTransfers = std::move(spentTransfers);
+  rebuildBalance();
 
   // Repair the container if it was broken while handling addTransaction() in previous version of the code
   // Hope it isn't necessary anymore
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <cstdint>
+#include <map>
 #include <unordered_map>
 #include <mutex>
 
@@ -256,6 +257,18 @@ private:
     >
   > SpentTransfersMultiIndex;
 
+  // balance contribution of the visible transfer of a key image
+  struct BalanceEntry {
+    uint64_t amount;
+    uint64_t unlockTime;
+    uint32_t blockHeight;
+    uint32_t state;
+    bool timeLocked;
+  };
+
+  // { block index or timestamp -> key images whose visible transfer may change its state }
+  typedef std::multimap<uint64_t, Crypto::KeyImage> UnlockJobs;
+
 private:
   void addTransaction(const TransactionBlockInfo& block, const ITransactionReader& tx);
   bool addTransactionOutputs(const TransactionBlockInfo& block, const ITransactionReader& tx,
@@ -266,6 +279,14 @@ private:
   bool isIncluded(const TransactionOutputInformationEx& info, uint32_t flags) const;
   static bool isIncluded(TransactionTypes::OutputType type, uint32_t state, uint32_t flags);
   void updateTransfersVisibility(const Crypto::KeyImage& keyImage);
+  void setCurrentHeight(uint32_t height);
+
+  void addBalanceEntry(const Crypto::KeyImage& keyImage, const TransactionOutputInformationEx& transfer);
+  void removeBalanceEntry(const Crypto::KeyImage& keyImage);
+  void rebuildBalance();
+  void processTimeUnlockJobs() const;
+  uint32_t getBalanceState(const BalanceEntry& entry, uint32_t height) const;
+  uint64_t& getBalance(uint32_t state) const;
 
   void copyToSpent(const TransactionBlockInfo& block, const ITransactionReader& tx, size_t inputIndex, const TransactionOutputInformationEx& output);
   void repair();
@@ -276,6 +297,14 @@ private:
   AvailableTransfersMultiIndex m_availableTransfers;
   SpentTransfersMultiIndex m_spentTransfers;
 
+  // running totals of visible key outputs per state, moved between states by the unlock jobs
+  mutable std::unordered_map<Crypto::KeyImage, BalanceEntry> m_balanceEntries;
+  UnlockJobs m_heightUnlockJobs;
+  mutable UnlockJobs m_timeUnlockJobs;
+  mutable uint64_t m_lockedBalance;
+  mutable uint64_t m_softLockedBalance;
+  mutable uint64_t m_unlockedBalance;
+
   uint32_t m_currentHeight; // current height is needed to check if a transfer is unlocked
   size_t m_transactionSpendableAge;
   const CryptoNote::Currency& m_currency;
@@ -17,6 +17,7 @@
 
 #include "TransfersSynchronizer.h"
 #include "TransfersConsumer.h"
+#include "SynchronizationState.h"
 
 #include "Common/StdInputStream.h"
 #include "Common/StdOutputStream.h"
@@ -29,10 +30,11 @@ using namespace Crypto;
 
 namespace CryptoNote {
 
-const uint32_t TRANSFERS_STORAGE_ARCHIVE_VERSION = 0;
+const uint32_t TRANSFERS_STORAGE_ARCHIVE_VERSION = 1;
+const uint32_t TRANSFERS_CHANGES_ARCHIVE_VERSION = 0;
 
 TransfersSyncronizer::TransfersSyncronizer(const CryptoNote::Currency& currency, Logging::ILogger& logger, IBlockchainSynchronizer& sync, INode& node) :
-  m_currency(currency), m_logger(logger, "TransfersSyncronizer"), m_sync(sync), m_node(node) {
+  m_currency(currency), m_logger(logger, "TransfersSyncronizer"), m_sync(sync), m_node(node), m_subscriptionsChanged(false) {
 }
 
 TransfersSyncronizer::~TransfersSyncronizer() {
@@ -40,15 +42,29 @@ TransfersSyncronizer::~TransfersSyncronizer() {
   for (const auto& kv : m_consumers) {
     m_sync.removeConsumer(kv.second.get());
   }
+
+  for (const auto& kv : m_catchUpConsumers) {
+    for (const auto& consumer : kv.second) {
+      m_sync.removeConsumer(consumer.get());
+    }
+  }
 }
 
 void TransfersSyncronizer::initTransactionPool(const std::unordered_set<Crypto::Hash>& uncommitedTransactions) {
   for (auto it = m_consumers.begin(); it != m_consumers.end(); ++it) {
     it->second->initTransactionPool(uncommitedTransactions);
   }
+
+  for (auto it = m_catchUpConsumers.begin(); it != m_catchUpConsumers.end(); ++it) {
+    for (auto& consumer : it->second) {
+      consumer->initTransactionPool(uncommitedTransactions);
+    }
+  }
 }
 
 ITransfersSubscription& TransfersSyncronizer::addSubscription(const AccountSubscription& acc) {
+  m_subscriptionsChanged = true;
+
   auto it = m_consumers.find(acc.keys.address.viewPublicKey);
 
   if (it == m_consumers.end()) {
@@ -63,13 +79,129 @@ ITransfersSubscription& TransfersSyncronizer::addSubscription(const AccountSubsc
   return it->second->addSubscription(acc);
 }
 
+ITransfersSubscription& TransfersSyncronizer::addCatchUpSubscription(const AccountSubscription& acc) {
+  auto it = m_consumers.find(acc.keys.address.viewPublicKey);
+  if (it == m_consumers.end() || m_sync.getConsumerKnownBlocks(*it->second).size() <= 1) {
+    // nothing to catch up with, the main consumer scans from the beginning anyway
+    return addSubscription(acc);
+  }
+
+  if (it->second->getSubscription(acc.keys.address) != nullptr) {
+    return *it->second->getSubscription(acc.keys.address);
+  }
+
+  // subscriptions added together share a consumer until it receives its first blocks
+  TransfersConsumer* consumer = nullptr;
+  auto& catchUpConsumers = m_catchUpConsumers[acc.keys.address.viewPublicKey];
+  for (auto& catchUpConsumer : catchUpConsumers) {
+    if (catchUpConsumer->getSubscription(acc.keys.address) != nullptr) {
+      return *catchUpConsumer->getSubscription(acc.keys.address);
+    }
+
+    if (m_sync.getConsumerKnownBlocks(*catchUpConsumer).size() <= 1) {
+      consumer = catchUpConsumer.get();
+    }
+  }
+
+  if (consumer == nullptr) {
+    consumer = addCatchUpConsumer(acc.keys.address.viewPublicKey, acc.keys.viewSecretKey);
+  }
+
+  m_subscriptionsChanged = true;
+  m_logger(Logging::DEBUGGING) << "Catch up subscription added: " << m_currency.accountAddressAsString(acc.keys.address);
+  return consumer->addSubscription(acc);
+}
+
+bool TransfersSyncronizer::hasCatchUpSubscriptions() const {
+  return !m_catchUpConsumers.empty();
+}
+
+bool TransfersSyncronizer::hasCaughtUpSubscriptions() const {
+  for (const auto& kv : m_catchUpConsumers) {
+    auto& consumer = *m_consumers.at(kv.first);
+    for (const auto& catchUpConsumer : kv.second) {
+      if (isCaughtUp(consumer, *catchUpConsumer)) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+size_t TransfersSyncronizer::mergeCaughtUpSubscriptions() {
+  size_t mergedCount = 0;
+
+  for (auto it = m_catchUpConsumers.begin(); it != m_catchUpConsumers.end();) {
+    auto& consumer = *m_consumers.at(it->first);
+    auto& catchUpConsumers = it->second;
+
+    for (auto consumerIt = catchUpConsumers.begin(); consumerIt != catchUpConsumers.end();) {
+      if (isCaughtUp(consumer, **consumerIt)) {
+        std::vector<AccountPublicAddress> subscriptions;
+        (*consumerIt)->getSubscriptions(subscriptions);
+        consumer.merge(**consumerIt);
+        mergedCount += subscriptions.size();
+
+        m_sync.removeConsumer(consumerIt->get());
+        consumerIt = catchUpConsumers.erase(consumerIt);
+      } else {
+        ++consumerIt;
+      }
+    }
+
+    it = catchUpConsumers.empty() ? m_catchUpConsumers.erase(it) : std::next(it);
+  }
+
+  if (mergedCount != 0) {
+    m_subscriptionsChanged = true;
+    m_logger(Logging::DEBUGGING) << "Caught up subscriptions merged: " << mergedCount;
+  }
+
+  return mergedCount;
+}
+
 bool TransfersSyncronizer::removeSubscription(const AccountPublicAddress& acc) {
   auto it = m_consumers.find(acc.viewPublicKey);
   if (it == m_consumers.end())
     return false;
 
+  m_subscriptionsChanged = true;
+
+  auto catchUpIt = m_catchUpConsumers.find(acc.viewPublicKey);
+  if (catchUpIt != m_catchUpConsumers.end()) {
+    for (auto& consumer : catchUpIt->second) {
+      if (consumer->getSubscription(acc) != nullptr) {
+        if (consumer->removeSubscription(acc)) {
+          removeCatchUpConsumer(acc.viewPublicKey, consumer.get());
+        }
+
+        return true;
+      }
+    }
+  }
+
   if (it->second->removeSubscription(acc)) {
     m_sync.removeConsumer(it->second.get());
+
+    catchUpIt = m_catchUpConsumers.find(acc.viewPublicKey);
+    if (catchUpIt != m_catchUpConsumers.end()) {
+      // a catch up consumer becomes the main one, observers drop the blocks it hasn't scanned yet
+      it->second = std::move(catchUpIt->second.front());
+      catchUpIt->second.erase(catchUpIt->second.begin());
+      if (catchUpIt->second.empty()) {
+        m_catchUpConsumers.erase(catchUpIt);
+      }
+
+      auto subscriberIt = m_subscribers.find(acc.viewPublicKey);
+      if (subscriberIt != m_subscribers.end()) {
+        auto blockCount = static_cast<uint32_t>(m_sync.getConsumerKnownBlocks(*it->second).size());
+        subscriberIt->second->notify(&ITransfersSynchronizerObserver::onBlockchainDetach, acc.viewPublicKey, blockCount);
+      }
+
+      return true;
+    }
+
     m_consumers.erase(it);
 
     m_subscribers.erase(acc.viewPublicKey);
@@ -82,11 +214,17 @@ void TransfersSyncronizer::getSubscriptions(std::vector<AccountPublicAddress>& s
   for (const auto& kv : m_consumers) {
     kv.second->getSubscriptions(subscriptions);
   }
+
+  for (const auto& kv : m_catchUpConsumers) {
+    for (const auto& consumer : kv.second) {
+      consumer->getSubscriptions(subscriptions);
+    }
+  }
 }
 
 ITransfersSubscription* TransfersSyncronizer::getSubscription(const AccountPublicAddress& acc) {
-  auto it = m_consumers.find(acc.viewPublicKey);
-  return (it == m_consumers.end()) ? nullptr : it->second->getSubscription(acc);
+  auto consumer = findConsumerForSubscription(acc);
+  return consumer == nullptr ? nullptr : consumer->getSubscription(acc);
 }
 
 std::vector<Crypto::Hash> TransfersSyncronizer::getViewKeyKnownBlocks(const Crypto::PublicKey& publicViewKey) {
@@ -99,6 +237,11 @@ std::vector<Crypto::Hash> TransfersSyncronizer::getViewKeyKnownBlocks(const Cryp
 }
 
 void TransfersSyncronizer::onBlocksAdded(IBlockchainConsumer* consumer, const std::vector<Crypto::Hash>& blockHashes) {
+  // observers follow the blockchain of the main consumer only
+  if (isCatchUpConsumer(consumer)) {
+    return;
+  }
+
   auto it = findSubscriberForConsumer(consumer);
   if (it != m_subscribers.end()) {
     it->second->notify(&ITransfersSynchronizerObserver::onBlocksAdded, it->first, blockHashes);
@@ -106,6 +249,17 @@ void TransfersSyncronizer::onBlocksAdded(IBlockchainConsumer* consumer, const st
 }
 
 void TransfersSyncronizer::onBlockchainDetach(IBlockchainConsumer* consumer, uint32_t blockIndex) {
+  auto changedIt = m_changedBlockIndexes.find(consumer);
+  if (changedIt != m_changedBlockIndexes.end()) {
+    changedIt->second = std::min(changedIt->second, blockIndex);
+  }
+
+  markContainersChanged(consumer);
+
+  if (isCatchUpConsumer(consumer)) {
+    return;
+  }
+
   auto it = findSubscriberForConsumer(consumer);
   if (it != m_subscribers.end()) {
     it->second->notify(&ITransfersSynchronizerObserver::onBlockchainDetach, it->first, blockIndex);
@@ -120,6 +274,8 @@ void TransfersSyncronizer::onTransactionDeleteBegin(IBlockchainConsumer* consume
 }
 
 void TransfersSyncronizer::onTransactionDeleteEnd(IBlockchainConsumer* consumer, Crypto::Hash transactionHash) {
+  markContainersChanged(consumer);
+
   auto it = findSubscriberForConsumer(consumer);
   if (it != m_subscribers.end()) {
     it->second->notify(&ITransfersSynchronizerObserver::onTransactionDeleteEnd, it->first, transactionHash);
@@ -129,10 +285,34 @@ void TransfersSyncronizer::onTransactionDeleteEnd(IBlockchainConsumer* consumer,
 void TransfersSyncronizer::onTransactionUpdated(IBlockchainConsumer* consumer, const Crypto::Hash& transactionHash,
   const std::vector<ITransfersContainer*>& containers) {
 
+  m_changedContainers.insert(containers.begin(), containers.end());
+
   auto it = findSubscriberForConsumer(consumer);
-  if (it != m_subscribers.end()) {
+  if (it == m_subscribers.end()) {
+    return;
+  }
+
+  auto catchUpIt = m_catchUpConsumers.find(it->first);
+  if (catchUpIt == m_catchUpConsumers.end()) {
     it->second->notify(&ITransfersSynchronizerObserver::onTransactionUpdated, it->first, transactionHash, containers);
+    return;
+  }
+
+  // the transaction may also belong to subscriptions of other consumers of the view key,
+  // observers get all of them to compute transaction amounts
+  std::vector<ITransfersContainer*> allContainers(containers);
+  auto addContainers = [&](TransfersConsumer& other) {
+    if (&other != consumer) {
+      other.getTransactionContainers(transactionHash, allContainers);
+    }
+  };
+
+  addContainers(*m_consumers.at(it->first));
+  for (auto& catchUpConsumer : catchUpIt->second) {
+    addContainers(*catchUpConsumer);
   }
+
+  it->second->notify(&ITransfersSynchronizerObserver::onTransactionUpdated, it->first, transactionHash, allContainers);
 }
 
 void TransfersSyncronizer::subscribeConsumerNotifications(const Crypto::PublicKey& viewPublicKey, ITransfersSynchronizerObserver* observer) {
@@ -162,42 +342,63 @@ void TransfersSyncronizer::save(std::ostream& os) {
   s.beginArray(subscriptionCount, "consumers");
 
   for (const auto& consumer : m_consumers) {
-    s.beginObject("");
-    s(const_cast<PublicKey&>(consumer.first), "view_key");
+    saveConsumer(s, consumer.first, *consumer.second);
+  }
 
-    std::stringstream consumerState;
-    // synchronization state
-    m_sync.getConsumerState(consumer.second.get())->save(consumerState);
+  s.endArray();
 
-    std::string blob = consumerState.str();
-    s(blob, "state");
-    
-    std::vector<AccountPublicAddress> subscriptions;
-    consumer.second->getSubscriptions(subscriptions);
-    size_t subCount = subscriptions.size();
+  size_t catchUpCount = 0;
+  for (const auto& kv : m_catchUpConsumers) {
+    catchUpCount += kv.second.size();
+  }
 
-    s.beginArray(subCount, "subscriptions");
+  s.beginArray(catchUpCount, "catch_up_consumers");
 
-    for (auto& addr : subscriptions) {
-      auto sub = consumer.second->getSubscription(addr);
-      if (sub != nullptr) {
-        s.beginObject("");
+  for (const auto& kv : m_catchUpConsumers) {
+    for (const auto& consumer : kv.second) {
+      saveConsumer(s, kv.first, *consumer);
+    }
+  }
 
-        std::stringstream subState;
-        assert(sub);
-        sub->getContainer().save(subState);
-        // store data block
-        std::string blob = subState.str();
-        s(addr, "address");
-        s(blob, "state");
+  s.endArray();
+}
 
-        s.endObject();
-      }
-    }
+void TransfersSyncronizer::saveConsumer(ISerializer& s, const PublicKey& viewKey, TransfersConsumer& consumer) {
+  s.beginObject("");
+  s(const_cast<PublicKey&>(viewKey), "view_key");
 
-    s.endArray();
-    s.endObject();
+  std::stringstream consumerState;
+  // synchronization state
+  m_sync.getConsumerState(&consumer)->save(consumerState);
+
+  std::string blob = consumerState.str();
+  s(blob, "state");
+
+  std::vector<AccountPublicAddress> subscriptions;
+  consumer.getSubscriptions(subscriptions);
+  size_t subCount = subscriptions.size();
+
+  s.beginArray(subCount, "subscriptions");
+
+  for (auto& addr : subscriptions) {
+    auto sub = consumer.getSubscription(addr);
+    if (sub != nullptr) {
+      s.beginObject("");
+
+      std::stringstream subState;
+      assert(sub);
+      sub->getContainer().save(subState);
+      // store data block
+      std::string blob = subState.str();
+      s(addr, "address");
+      s(blob, "state");
+
+      s.endObject();
+    }
   }
+
+  s.endArray();
+  s.endObject();
 }
 
 namespace {
@@ -235,6 +436,8 @@ void TransfersSyncronizer::load(std::istream& is) {
   };
 
   std::vector<ConsumerState> updatedStates;
+  std::vector<std::pair<PublicKey, TransfersConsumer*>> addedCatchUpConsumers;
+  std::vector<std::pair<AccountPublicAddress, std::string>> catchUpStates;
 
   try {
     size_t subscriptionCount = 0;
@@ -297,8 +500,79 @@ void TransfersSyncronizer::load(std::istream& is) {
 
     s.endArray();
 
+    if (version >= 1) {
+      size_t catchUpCount = 0;
+      s.beginArray(catchUpCount, "catch_up_consumers");
+
+      while (catchUpCount--) {
+        s.beginObject("");
+        PublicKey viewKey;
+        s(viewKey, "view_key");
+
+        std::string blob;
+        s(blob, "state");
+
+        auto consumerIt = m_consumers.find(viewKey);
+        TransfersConsumer* consumer = nullptr;
+        if (consumerIt != m_consumers.end()) {
+          consumer = addCatchUpConsumer(viewKey, consumerIt->second->getViewSecretKey());
+          addedCatchUpConsumers.push_back(std::make_pair(viewKey, consumer));
+          setObjectState(*m_sync.getConsumerState(consumer), blob);
+        } else {
+          m_logger(Logging::DEBUGGING) << "Consumer not found: " << viewKey;
+        }
+
+        size_t subCount = 0;
+        s.beginArray(subCount, "subscriptions");
+
+        while (subCount--) {
+          s.beginObject("");
+
+          AccountPublicAddress acc;
+          std::string state;
+
+          s(acc, "address");
+          s(state, "state");
+
+          if (consumer != nullptr && consumerIt->second->moveSubscription(acc, *consumer)) {
+            auto sub = consumer->getSubscription(acc);
+            auto prevState = getObjectState(sub->getContainer());
+            setObjectState(sub->getContainer(), state);
+            catchUpStates.push_back(std::make_pair(acc, prevState));
+          } else {
+            m_logger(Logging::DEBUGGING) << "Subscription not found: " << m_currency.accountAddressAsString(acc);
+          }
+
+          s.endObject();
+        }
+
+        s.endArray();
+        s.endObject();
+
+        if (consumer != nullptr) {
+          std::vector<AccountPublicAddress> subscriptions;
+          consumer->getSubscriptions(subscriptions);
+          if (subscriptions.empty()) {
+            addedCatchUpConsumers.pop_back();
+            removeCatchUpConsumer(viewKey, consumer);
+          }
+        }
+      }
+
+      s.endArray();
+    }
+
   } catch (...) {
     // rollback state
+    for (const auto& added : addedCatchUpConsumers) {
+      m_consumers.at(added.first)->merge(*added.second);
+      removeCatchUpConsumer(added.first, added.second);
+    }
+
+    for (const auto& sub : catchUpStates) {
+      setObjectState(getSubscription(sub.first)->getContainer(), sub.second);
+    }
+
     for (const auto& consumerState : updatedStates) {
       auto consumer = m_consumers.find(consumerState.viewKey)->second.get();
       setObjectState(*m_sync.getConsumerState(consumer), consumerState.state);
@@ -311,18 +585,299 @@ void TransfersSyncronizer::load(std::istream& is) {
 
 }
 
+bool TransfersSyncronizer::canSaveChanges() const {
+  return !m_subscriptionsChanged;
+}
+
+void TransfersSyncronizer::saveChanges(std::ostream& os) {
+  assert(canSaveChanges());
+
+  StdOutputStream stream(os);
+  CryptoNote::BinaryOutputStreamSerializer s(stream);
+  s(const_cast<uint32_t&>(TRANSFERS_CHANGES_ARCHIVE_VERSION), "version");
+
+  size_t consumerCount = m_consumers.size();
+  for (const auto& kv : m_catchUpConsumers) {
+    consumerCount += kv.second.size();
+  }
+
+  s.beginArray(consumerCount, "consumers");
+
+  for (const auto& kv : m_consumers) {
+    saveConsumerChanges(s, kv.first, 0, *kv.second);
+  }
+
+  for (const auto& kv : m_catchUpConsumers) {
+    for (size_t i = 0; i < kv.second.size(); ++i) {
+      saveConsumerChanges(s, kv.first, static_cast<uint32_t>(i + 1), *kv.second[i]);
+    }
+  }
+
+  s.endArray();
+}
+
+void TransfersSyncronizer::saveConsumerChanges(ISerializer& s, const PublicKey& viewKey, uint32_t consumerIndex, TransfersConsumer& consumer) {
+  auto& state = getSynchronizationState(&consumer);
+  const auto& knownBlocks = state.getKnownBlockHashes();
+
+  // the genesis block never changes
+  uint32_t blockIndex = 1;
+  auto changedIt = m_changedBlockIndexes.find(&consumer);
+  if (changedIt != m_changedBlockIndexes.end()) {
+    blockIndex = std::max(blockIndex, changedIt->second);
+  }
+
+  blockIndex = std::min(blockIndex, state.getHeight());
+  std::vector<Hash> blocks(knownBlocks.begin() + blockIndex, knownBlocks.end());
+
+  s.beginObject("");
+  s(const_cast<PublicKey&>(viewKey), "view_key");
+  s(consumerIndex, "consumer_index");
+  s(blockIndex, "block_index");
+  s(blocks, "blocks");
+
+  std::vector<AccountPublicAddress> subscriptions;
+  consumer.getSubscriptions(subscriptions);
+
+  std::vector<std::pair<AccountPublicAddress, ITransfersContainer*>> changedSubscriptions;
+  for (auto& addr : subscriptions) {
+    auto sub = consumer.getSubscription(addr);
+    if (sub != nullptr && m_changedContainers.count(&sub->getContainer()) != 0) {
+      changedSubscriptions.emplace_back(addr, &sub->getContainer());
+    }
+  }
+
+  size_t subCount = changedSubscriptions.size();
+  s.beginArray(subCount, "subscriptions");
+
+  for (auto& sub : changedSubscriptions) {
+    s.beginObject("");
+
+    std::string blob = getObjectState(*sub.second);
+    s(sub.first, "address");
+    s(blob, "state");
+
+    s.endObject();
+  }
+
+  s.endArray();
+  s.endObject();
+}
+
+void TransfersSyncronizer::loadChanges(std::istream& in) {
+  StdInputStream inputStream(in);
+  CryptoNote::BinaryInputStreamSerializer s(inputStream);
+  uint32_t version = 0;
+
+  s(version, "version");
+
+  if (version > TRANSFERS_CHANGES_ARCHIVE_VERSION) {
+    throw std::runtime_error("TransfersSyncronizer changes version mismatch");
+  }
+
+  size_t consumerCount = 0;
+  s.beginArray(consumerCount, "consumers");
+
+  while (consumerCount--) {
+    loadConsumerChanges(s);
+  }
+
+  s.endArray();
+}
+
+void TransfersSyncronizer::loadConsumerChanges(ISerializer& s) {
+  s.beginObject("");
+
+  PublicKey viewKey;
+  uint32_t consumerIndex = 0;
+  uint32_t blockIndex = 0;
+  std::vector<Hash> blocks;
+  s(viewKey, "view_key");
+  s(consumerIndex, "consumer_index");
+  s(blockIndex, "block_index");
+  s(blocks, "blocks");
+
+  TransfersConsumer* consumer = findConsumer(viewKey, consumerIndex);
+  if (consumer == nullptr) {
+    throw std::runtime_error("Failed to load synchronization changes: consumer not found");
+  }
+
+  auto& state = getSynchronizationState(consumer);
+  if (blockIndex == 0 || blockIndex > state.getHeight()) {
+    throw std::runtime_error("Failed to load synchronization changes: block index doesn't match known blocks");
+  }
+
+  if (blockIndex < state.getHeight()) {
+    state.detach(blockIndex);
+  }
+
+  if (!blocks.empty()) {
+    state.addBlocks(blocks.data(), blockIndex, static_cast<uint32_t>(blocks.size()));
+  }
+
+  size_t subCount = 0;
+  s.beginArray(subCount, "subscriptions");
+
+  while (subCount--) {
+    s.beginObject("");
+
+    AccountPublicAddress acc;
+    std::string containerState;
+    s(acc, "address");
+    s(containerState, "state");
+
+    auto sub = consumer->getSubscription(acc);
+    if (sub == nullptr) {
+      throw std::runtime_error("Failed to load synchronization changes: subscription not found");
+    }
+
+    setObjectState(sub->getContainer(), containerState);
+
+    s.endObject();
+  }
+
+  s.endArray();
+  s.endObject();
+
+  // containers without changed transactions still follow the known blocks
+  consumer->advanceHeight(state.getHeight() - 1);
+}
+
+void TransfersSyncronizer::resetChanges() {
+  m_subscriptionsChanged = false;
+  m_changedContainers.clear();
+  m_changedBlockIndexes.clear();
+
+  for (const auto& kv : m_consumers) {
+    m_changedBlockIndexes.emplace(kv.second.get(), getSynchronizationState(kv.second.get()).getHeight());
+  }
+
+  for (const auto& kv : m_catchUpConsumers) {
+    for (const auto& consumer : kv.second) {
+      m_changedBlockIndexes.emplace(consumer.get(), getSynchronizationState(consumer.get()).getHeight());
+    }
+  }
+}
+
+TransfersConsumer* TransfersSyncronizer::findConsumer(const PublicKey& viewKey, uint32_t consumerIndex) const {
+  if (consumerIndex == 0) {
+    auto it = m_consumers.find(viewKey);
+    return it == m_consumers.end() ? nullptr : it->second.get();
+  }
+
+  auto it = m_catchUpConsumers.find(viewKey);
+  if (it == m_catchUpConsumers.end() || consumerIndex > it->second.size()) {
+    return nullptr;
+  }
+
+  return it->second[consumerIndex - 1].get();
+}
+
+void TransfersSyncronizer::markContainersChanged(IBlockchainConsumer* consumer) {
+  // the synchronizer observes its own transfers consumers only
+  auto transfersConsumer = static_cast<TransfersConsumer*>(consumer);
+
+  std::vector<AccountPublicAddress> subscriptions;
+  transfersConsumer->getSubscriptions(subscriptions);
+  for (auto& addr : subscriptions) {
+    m_changedContainers.insert(&transfersConsumer->getSubscription(addr)->getContainer());
+  }
+}
+
+SynchronizationState& TransfersSyncronizer::getSynchronizationState(IBlockchainConsumer* consumer) const {
+  auto state = dynamic_cast<SynchronizationState*>(m_sync.getConsumerState(consumer));
+  if (state == nullptr) {
+    throw std::invalid_argument("Consumer synchronization state not found");
+  }
+
+  return *state;
+}
+
+TransfersConsumer* TransfersSyncronizer::findConsumerForSubscription(const AccountPublicAddress& acc) const {
+  auto it = m_consumers.find(acc.viewPublicKey);
+  if (it == m_consumers.end()) {
+    return nullptr;
+  }
+
+  auto catchUpIt = m_catchUpConsumers.find(acc.viewPublicKey);
+  if (catchUpIt != m_catchUpConsumers.end()) {
+    for (const auto& consumer : catchUpIt->second) {
+      if (consumer->getSubscription(acc) != nullptr) {
+        return consumer.get();
+      }
+    }
+  }
+
+  return it->second.get();
+}
+
+TransfersConsumer* TransfersSyncronizer::addCatchUpConsumer(const PublicKey& viewPublicKey, const SecretKey& viewSecretKey) {
+  std::unique_ptr<TransfersConsumer> consumer(new TransfersConsumer(m_currency, m_node, m_logger.getLogger(), viewSecretKey));
+
+  m_sync.addConsumer(consumer.get());
+  consumer->addObserver(this);
+
+  auto& consumers = m_catchUpConsumers[viewPublicKey];
+  consumers.push_back(std::move(consumer));
+  return consumers.back().get();
+}
+
+void TransfersSyncronizer::removeCatchUpConsumer(const PublicKey& viewPublicKey, TransfersConsumer* consumer) {
+  auto it = m_catchUpConsumers.find(viewPublicKey);
+  assert(it != m_catchUpConsumers.end());
+
+  auto consumerIt = std::find_if(it->second.begin(), it->second.end(), [consumer] (const std::unique_ptr<TransfersConsumer>& item) {
+    return item.get() == consumer;
+  });
+
+  assert(consumerIt != it->second.end());
+  m_sync.removeConsumer(consumer);
+  it->second.erase(consumerIt);
+
+  if (it->second.empty()) {
+    m_catchUpConsumers.erase(it);
+  }
+}
+
+bool TransfersSyncronizer::isCaughtUp(TransfersConsumer& consumer, TransfersConsumer& catchUpConsumer) const {
+  auto blocks = m_sync.getConsumerKnownBlocks(consumer);
+  auto catchUpBlocks = m_sync.getConsumerKnownBlocks(catchUpConsumer);
+  return blocks.size() == catchUpBlocks.size() && blocks.back() == catchUpBlocks.back();
+}
+
+bool TransfersSyncronizer::isCatchUpConsumer(IBlockchainConsumer* consumer) const {
+  for (const auto& kv : m_catchUpConsumers) {
+    for (const auto& catchUpConsumer : kv.second) {
+      if (catchUpConsumer.get() == consumer) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
 bool TransfersSyncronizer::findViewKeyForConsumer(IBlockchainConsumer* consumer, Crypto::PublicKey& viewKey) const {
   //since we have only couple of consumers linear complexity is fine
   auto it = std::find_if(m_consumers.begin(), m_consumers.end(), [consumer] (const ConsumersContainer::value_type& subscription) {
     return subscription.second.get() == consumer;
   });
 
-  if (it == m_consumers.end()) {
-    return false;
+  if (it != m_consumers.end()) {
+    viewKey = it->first;
+    return true;
   }
 
-  viewKey = it->first;
-  return true;
+  for (const auto& kv : m_catchUpConsumers) {
+    for (const auto& catchUpConsumer : kv.second) {
+      if (catchUpConsumer.get() == consumer) {
+        viewKey = kv.first;
+        return true;
+      }
+    }
+  }
+
+  return false;
 }
 
 TransfersSyncronizer::SubscribersContainer::const_iterator TransfersSyncronizer::findSubscriberForConsumer(IBlockchainConsumer* consumer) const {
@@ -23,6 +23,7 @@
 #include "TypeHelpers.h"
 
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <cstring>
 
@@ -35,7 +36,9 @@ class Currency;
 namespace CryptoNote {
  
 class TransfersConsumer;
+class SynchronizationState;
 class INode;
+class ISerializer;
 
 class TransfersSyncronizer : public ITransfersSynchronizer, public IBlockchainConsumerObserver {
 public:
@@ -46,6 +49,13 @@ public:
 
   // ITransfersSynchronizer
   virtual ITransfersSubscription& addSubscription(const AccountSubscription& acc) override;
+  // Adds a subscription that scans the blockchain from its own sync start in a separate consumer, while the
+  // subscriptions of the same view key keep following the tip. The synchronizer must be stopped.
+  ITransfersSubscription& addCatchUpSubscription(const AccountSubscription& acc);
+  bool hasCatchUpSubscriptions() const;
+  bool hasCaughtUpSubscriptions() const;
+  // Moves subscriptions of caught up consumers to the main consumer of their view key. The synchronizer must be stopped.
+  size_t mergeCaughtUpSubscriptions();
   virtual bool removeSubscription(const AccountPublicAddress& acc) override;
   virtual void getSubscriptions(std::vector<AccountPublicAddress>& subscriptions) override;
   virtual ITransfersSubscription* getSubscription(const AccountPublicAddress& acc) override;
@@ -58,6 +68,13 @@ public:
   virtual void save(std::ostream& os) override;
   virtual void load(std::istream& in) override;
 
+  // Changes made by the blockchain synchronizer since the last resetChanges(): new and detached blocks of
+  // consumers and states of changed transfers containers. Changed subscriptions require a full save().
+  bool canSaveChanges() const;
+  void saveChanges(std::ostream& os);
+  void loadChanges(std::istream& in);
+  void resetChanges();
+
 private:
   Logging::LoggerRef m_logger;
 
@@ -65,6 +82,10 @@ private:
   typedef std::unordered_map<Crypto::PublicKey, std::unique_ptr<TransfersConsumer>> ConsumersContainer;
   ConsumersContainer m_consumers;
 
+  // map { view public key -> consumers rescanning the blockchain for recently added subscriptions }
+  typedef std::unordered_map<Crypto::PublicKey, std::vector<std::unique_ptr<TransfersConsumer>>> CatchUpConsumersContainer;
+  CatchUpConsumersContainer m_catchUpConsumers;
+
   typedef Tools::ObserverManager<ITransfersSynchronizerObserver> SubscribersNotifier;
   typedef std::unordered_map<Crypto::PublicKey, std::unique_ptr<SubscribersNotifier>> SubscribersContainer;
   SubscribersContainer m_subscribers;
@@ -74,6 +95,11 @@ private:
   INode& m_node;
   const CryptoNote::Currency& m_currency;
 
+  // consumer -> index of the first block changed since the last resetChanges()
+  std::unordered_map<IBlockchainConsumer*, uint32_t> m_changedBlockIndexes;
+  std::unordered_set<const ITransfersContainer*> m_changedContainers;
+  bool m_subscriptionsChanged;
+
   virtual void onBlocksAdded(IBlockchainConsumer* consumer, const std::vector<Crypto::Hash>& blockHashes) override;
   virtual void onBlockchainDetach(IBlockchainConsumer* consumer, uint32_t blockIndex) override;
   virtual void onTransactionDeleteBegin(IBlockchainConsumer* consumer, Crypto::Hash transactionHash) override;
@@ -81,6 +107,18 @@ private:
   virtual void onTransactionUpdated(IBlockchainConsumer* consumer, const Crypto::Hash& transactionHash,
     const std::vector<ITransfersContainer*>& containers) override;
 
+  TransfersConsumer* findConsumerForSubscription(const AccountPublicAddress& acc) const;
+  TransfersConsumer* addCatchUpConsumer(const Crypto::PublicKey& viewPublicKey, const Crypto::SecretKey& viewSecretKey);
+  void removeCatchUpConsumer(const Crypto::PublicKey& viewPublicKey, TransfersConsumer* consumer);
+  bool isCaughtUp(TransfersConsumer& consumer, TransfersConsumer& catchUpConsumer) const;
+  void saveConsumer(ISerializer& s, const Crypto::PublicKey& viewKey, TransfersConsumer& consumer);
+  void saveConsumerChanges(ISerializer& s, const Crypto::PublicKey& viewKey, uint32_t consumerIndex, TransfersConsumer& consumer);
+  void loadConsumerChanges(ISerializer& s);
+  TransfersConsumer* findConsumer(const Crypto::PublicKey& viewKey, uint32_t consumerIndex) const;
+  void markContainersChanged(IBlockchainConsumer* consumer);
+  SynchronizationState& getSynchronizationState(IBlockchainConsumer* consumer) const;
+
+  bool isCatchUpConsumer(IBlockchainConsumer* consumer) const;
   bool findViewKeyForConsumer(IBlockchainConsumer* consumer, Crypto::PublicKey& viewKey) const;
   SubscribersContainer::const_iterator findSubscriberForConsumer(IBlockchainConsumer* consumer) const;
 };
@@ -60,6 +60,46 @@ using namespace Logging;
 
 namespace {
 
+const uint8_t WALLET_JOURNAL_VERSION = 2;
+// The journal is compacted into the container cache once it grows beyond this part of the cache size
+const uint64_t WALLET_JOURNAL_COMPACTION_RATIO = 4;
+
+#pragma pack(push, 1)
+struct WalletJournalPrefix {
+  uint8_t version;
+  Crypto::chacha8_iv cacheIv; // IV of the container cache the journal records apply to
+};
+
+struct WalletJournalRecordHeader {
+  uint32_t size;
+  Crypto::chacha8_iv iv;
+  Crypto::Hash checksum; // hash of the decrypted record, detects a torn tail after a crash
+};
+#pragma pack(pop)
+
+std::string getJournalPath(const std::string& path) {
+  return path + ".journal";
+}
+
+Crypto::chacha8_iv getContainerCacheIv(const CryptoNote::ContainerStorage& storage) {
+  Common::MemoryInputStream suffixStream(storage.suffix(), storage.suffixSize());
+  CryptoNote::BinaryInputStreamSerializer suffixSerializer(suffixStream);
+  Crypto::chacha8_iv suffixIv;
+  suffixSerializer(suffixIv, "suffixIv");
+  return suffixIv;
+}
+
+void appendToJournal(CryptoNote::WalletJournalStorage& journal, const void* data, size_t size) {
+  if (journal.size() + size > journal.capacity()) {
+    journal.reserve(std::max(journal.size() + size, journal.capacity() * 2));
+  }
+
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    journal.push_back(bytes[i]);
+  }
+}
+
 void asyncRequestCompletion(System::Event& requestFinished) {
   requestFinished.set();
 }
@@ -136,6 +176,7 @@ WalletGreen::WalletGreen(System::Dispatcher& dispatcher, const Currency& currenc
   m_node(node),
   m_logger(logger, "WalletGreen/empty"),
   m_stopped(false),
+  m_journalEnabled(false),
   m_blockchainSynchronizerStarted(false),
   m_blockchainSynchronizer(node, logger, currency.genesisBlockHash()),
   m_synchronizer(currency, logger, m_blockchainSynchronizer, node),
@@ -195,6 +236,7 @@ void WalletGreen::doShutdown() {
   stopBlockchainSynchronizer();
   m_blockchainSynchronizer.removeObserver(this);
 
+  closeWalletJournal();
   m_containerStorage.close();
   m_walletsContainer.clear();
   clearCaches(true, true);
@@ -236,6 +278,7 @@ void WalletGreen::clearCaches(bool clearTransactions, bool clearCachedData) {
 
     m_uncommitedTransactions.clear();
     m_unlockTransactionsJob.clear();
+    m_journalEnabled = false;
     m_actualBalance = 0;
     m_pendingBalance = 0;
     m_fusionTxsCache.clear();
@@ -355,7 +398,12 @@ void WalletGreen::save(WalletSaveLevel saveLevel, const std::string& extra) {
   stopBlockchainSynchronizer();
 
   try {
-    saveWalletCache(m_containerStorage, m_key, saveLevel, extra);
+    if (saveLevel == WalletSaveLevel::SAVE_ALL && canSaveWalletJournal()) {
+      saveWalletJournal(extra);
+    } else {
+      saveWalletCache(m_containerStorage, m_key, saveLevel, extra);
+      resetWalletJournal(saveLevel);
+    }
   } catch (const std::exception& e) {
     m_logger(ERROR, BRIGHT_RED) << "Failed to save container: " << e.what();
     startBlockchainSynchronizer();
@@ -452,6 +500,7 @@ void WalletGreen::load(const std::string& path, const std::string& password, std
         std::unordered_set<Crypto::PublicKey> addedSpendKeys;
         std::unordered_set<Crypto::PublicKey> deletedSpendKeys;
         loadWalletCache(addedSpendKeys, deletedSpendKeys, extra);
+        loadWalletJournal(path, extra);
 
         if (!addedSpendKeys.empty()) {
           m_logger(WARNING, BRIGHT_YELLOW) << "Found addresses not saved in container cache. Resynchronize container";
@@ -466,6 +515,7 @@ void WalletGreen::load(const std::string& path, const std::string& password, std
 
         if (!addedSpendKeys.empty() || !deletedSpendKeys.empty()) {
           saveWalletCache(m_containerStorage, m_key, WalletSaveLevel::SAVE_ALL, extra);
+          closeWalletJournal();
         }
       } catch (const std::exception& e) {
         m_logger(ERROR, BRIGHT_RED) << "Failed to load cache: " << e.what() << ", reset wallet data";
@@ -613,6 +663,177 @@ void WalletGreen::saveWalletCache(ContainerStorage& storage, const Crypto::chach
   m_logger(DEBUGGING) << "Container saving finished";
 }
 
+bool WalletGreen::canSaveWalletJournal() const {
+  return m_journalEnabled && m_synchronizer.canSaveChanges() && m_journal.size() * WALLET_JOURNAL_COMPACTION_RATIO < m_containerStorage.suffixSize();
+}
+
+void WalletGreen::saveWalletJournal(const std::string& extra) {
+  m_logger(DEBUGGING) << "Saving journal record...";
+
+  std::vector<Crypto::PublicKey> changedWallets;
+  for (const auto& wallet : m_walletsContainer.get<RandomAccessIndex>()) {
+    auto it = m_savedBalances.find(wallet.spendPublicKey);
+    if (it == m_savedBalances.end() || it->second.first != wallet.actualBalance || it->second.second != wallet.pendingBalance) {
+      changedWallets.push_back(wallet.spendPublicKey);
+    }
+  }
+
+  std::string recordData;
+  Common::StringOutputStream recordStream(recordData);
+
+  WalletSerializerV2 s(
+    *this,
+    m_viewPublicKey,
+    m_viewSecretKey,
+    m_actualBalance,
+    m_pendingBalance,
+    m_walletsContainer,
+    m_synchronizer,
+    m_unlockTransactionsJob,
+    m_transactions,
+    m_transfers,
+    m_uncommitedTransactions,
+    const_cast<std::string&>(extra),
+    m_transactionSoftLockTime
+  );
+
+  s.saveJournalRecord(recordStream, changedWallets, m_unsavedTransactions);
+
+  WalletJournalRecordHeader header;
+  header.size = static_cast<uint32_t>(recordData.size());
+  // A random IV keeps the container untouched, the record carries it in its header
+  header.iv = Crypto::rand<Crypto::chacha8_iv>();
+  Crypto::cn_fast_hash(recordData.data(), recordData.size(), header.checksum);
+
+  std::string encryptedRecord;
+  encryptedRecord.resize(recordData.size());
+  chacha8(recordData.data(), recordData.size(), m_key, header.iv, &encryptedRecord[0]);
+
+  appendToJournal(m_journal, &header, sizeof(header));
+  appendToJournal(m_journal, encryptedRecord.data(), encryptedRecord.size());
+  m_journal.flush();
+
+  m_extra = extra;
+  markWalletCacheSaved();
+
+  m_logger(DEBUGGING) << "Journal record saved, transactions " << m_unsavedTransactions.size() <<
+    ", wallets " << changedWallets.size() << ", journal size " << m_journal.size();
+}
+
+void WalletGreen::loadWalletJournal(const std::string& path, std::string& extra) {
+  assert(!m_journalEnabled);
+
+  std::string journalPath = getJournalPath(path);
+  if (!boost::filesystem::exists(journalPath)) {
+    return;
+  }
+
+  m_journal.open(journalPath, FileMappedVectorOpenMode::OPEN, sizeof(WalletJournalPrefix));
+  m_journal.setAutoFlush(false);
+
+  const WalletJournalPrefix* prefix = reinterpret_cast<const WalletJournalPrefix*>(m_journal.prefix());
+  Crypto::chacha8_iv cacheIv = getContainerCacheIv(m_containerStorage);
+  if (prefix->version != WALLET_JOURNAL_VERSION || memcmp(&prefix->cacheIv, &cacheIv, sizeof(cacheIv)) != 0) {
+    m_logger(WARNING, BRIGHT_YELLOW) << "Container journal doesn't belong to container cache, ignore it";
+    m_journal.close();
+    return;
+  }
+
+  uint64_t offset = 0;
+  size_t recordCount = 0;
+  while (m_journal.size() - offset >= sizeof(WalletJournalRecordHeader)) {
+    WalletJournalRecordHeader header;
+    memcpy(&header, m_journal.data() + offset, sizeof(header));
+    if (header.size > m_journal.size() - offset - sizeof(header)) {
+      break;
+    }
+
+    std::string recordData;
+    recordData.resize(header.size);
+    chacha8(m_journal.data() + offset + sizeof(header), header.size, m_key, header.iv, &recordData[0]);
+
+    Crypto::Hash checksum;
+    Crypto::cn_fast_hash(recordData.data(), recordData.size(), checksum);
+    if (checksum != header.checksum) {
+      break;
+    }
+
+    WalletSerializerV2 s(
+      *this,
+      m_viewPublicKey,
+      m_viewSecretKey,
+      m_actualBalance,
+      m_pendingBalance,
+      m_walletsContainer,
+      m_synchronizer,
+      m_unlockTransactionsJob,
+      m_transactions,
+      m_transfers,
+      m_uncommitedTransactions,
+      extra,
+      m_transactionSoftLockTime
+    );
+
+    Common::MemoryInputStream recordStream(recordData.data(), recordData.size());
+    s.loadJournalRecord(recordStream);
+
+    offset += sizeof(header) + header.size;
+    ++recordCount;
+  }
+
+  if (offset != m_journal.size()) {
+    m_logger(WARNING, BRIGHT_YELLOW) << "Container journal has an incomplete record, dropped " << m_journal.size() - offset << " bytes";
+    m_journal.erase(std::next(m_journal.cbegin(), offset), m_journal.cend());
+    m_journal.flush();
+  }
+
+  m_journalEnabled = true;
+  markWalletCacheSaved();
+
+  m_logger(DEBUGGING) << "Container journal loaded, records " << recordCount;
+}
+
+void WalletGreen::resetWalletJournal(WalletSaveLevel saveLevel) {
+  closeWalletJournal();
+
+  std::string journalPath = getJournalPath(m_path);
+  boost::system::error_code ignore;
+  boost::filesystem::remove(journalPath, ignore);
+
+  // Only a full cache keeps everything journal records are applied to
+  if (saveLevel != WalletSaveLevel::SAVE_ALL) {
+    return;
+  }
+
+  m_journal.open(journalPath, FileMappedVectorOpenMode::CREATE, sizeof(WalletJournalPrefix));
+  WalletJournalPrefix* prefix = reinterpret_cast<WalletJournalPrefix*>(m_journal.prefix());
+  prefix->version = WALLET_JOURNAL_VERSION;
+  prefix->cacheIv = getContainerCacheIv(m_containerStorage);
+  m_journal.flush();
+  m_journal.setAutoFlush(false);
+
+  m_journalEnabled = true;
+  markWalletCacheSaved();
+}
+
+void WalletGreen::closeWalletJournal() {
+  if (m_journal.isOpened()) {
+    m_journal.close();
+  }
+
+  m_journalEnabled = false;
+}
+
+void WalletGreen::markWalletCacheSaved() {
+  m_unsavedTransactions.clear();
+  m_synchronizer.resetChanges();
+
+  m_savedBalances.clear();
+  for (const auto& wallet : m_walletsContainer.get<RandomAccessIndex>()) {
+    m_savedBalances.emplace(wallet.spendPublicKey, std::make_pair(wallet.actualBalance, wallet.pendingBalance));
+  }
+}
+
 void WalletGreen::copyContainerStorageKeys(ContainerStorage& src, const chacha8_key& srcKey, ContainerStorage& dst, const chacha8_key& dstKey) {
   m_logger(DEBUGGING) << "Copying wallet keys...";
   dst.reserve(src.size());
@@ -862,6 +1083,16 @@ void WalletGreen::changePassword(const std::string& oldPassword, const std::stri
     return;
   }
 
+  if (m_journal.isOpened() && !m_journal.empty()) {
+    // Journal records are encrypted with the old key, so fold them into the cache first
+    stopBlockchainSynchronizer();
+    saveWalletCache(m_containerStorage, m_key, WalletSaveLevel::SAVE_ALL, m_extra);
+    startBlockchainSynchronizer();
+  }
+
+  // The cache gets a new IV, the journal is recreated on the next save
+  closeWalletJournal();
+
   Crypto::cn_context cnContext;
   Crypto::chacha8_key newKey;
   Crypto::generate_chacha8_key(cnContext, newPassword, newKey);
@@ -1001,8 +1232,6 @@ std::vector<std::string> WalletGreen::doCreateAddressList(const std::vector<NewA
 
   std::vector<std::string> addresses;
   try {
-    uint64_t minCreationTimestamp = std::numeric_limits<uint64_t>::max();
-
     {
       if (addressDataList.size() > 1) {
         m_containerStorage.setAutoFlush(false);
@@ -1020,19 +1249,10 @@ std::vector<std::string> WalletGreen::doCreateAddressList(const std::vector<NewA
         std::string address = addWallet(addressData.spendPublicKey, addressData.spendSecretKey, addressData.creationTimestamp);
         m_logger(INFO, BRIGHT_WHITE) << "New wallet added " << address << ", creation timestamp " << addressData.creationTimestamp;
         addresses.push_back(std::move(address));
-
-        minCreationTimestamp = std::min(minCreationTimestamp, addressData.creationTimestamp);
       }
     }
 
     m_containerStorage.setAutoFlush(true);
-    auto currentTime = static_cast<uint64_t>(time(nullptr));
-    if (minCreationTimestamp + m_currency.blockFutureTimeLimit() < currentTime) {
-      m_logger(DEBUGGING) << "Reset is required";
-      save(WalletSaveLevel::SAVE_KEYS_AND_TRANSACTIONS, m_extra);
-      shutdown();
-      load(m_path, m_password);
-    }
   } catch (const std::exception& e) {
     m_logger(ERROR, BRIGHT_RED) << "Failed to add wallets: " << e.what();
     startBlockchainSynchronizer();
@@ -1065,6 +1285,8 @@ std::string WalletGreen::addWallet(const Crypto::PublicKey& spendPublicKey, cons
 
   m_containerStorage.push_back(encryptKeyPair(spendPublicKey, spendSecretKey, creationTimestamp));
   incNextIv();
+  // The address list of the cache must match the container keys, so the next save rewrites the cache
+  m_journalEnabled = false;
 
   try {
     AccountSubscription sub;
@@ -1076,7 +1298,15 @@ std::string WalletGreen::addWallet(const Crypto::PublicKey& spendPublicKey, cons
     sub.syncStart.height = 0;
     sub.syncStart.timestamp = std::max(creationTimestamp, ACCOUNT_CREATE_TIME_ACCURACY) - ACCOUNT_CREATE_TIME_ACCURACY;
 
-    auto& trSubscription = m_synchronizer.addSubscription(sub);
+    // An address created in the past is rescanned from its creation time on its own,
+    // the other addresses keep following the tip
+    auto currentTime = static_cast<uint64_t>(time(nullptr));
+    bool rescanRequired = creationTimestamp + m_currency.blockFutureTimeLimit() < currentTime;
+    if (rescanRequired) {
+      m_logger(DEBUGGING) << "Rescan is required, creation timestamp " << creationTimestamp;
+    }
+
+    auto& trSubscription = rescanRequired ? m_synchronizer.addCatchUpSubscription(sub) : m_synchronizer.addSubscription(sub);
     ITransfersContainer* container = &trSubscription.getContainer();
 
     WalletRecord wallet;
@@ -1174,6 +1404,7 @@ void WalletGreen::deleteAddress(const std::string& address) {
 #endif
 
   m_containerStorage.erase(std::next(m_containerStorage.begin(), addressIndex));
+  m_journalEnabled = false;
 
   m_synchronizer.removeSubscription(pubAddr);
 
@@ -2538,6 +2769,12 @@ void WalletGreen::onSynchronizationCompleted() {
   }
 
   pushEvent(makeSyncCompletedEvent());
+
+  if (m_blockchainSynchronizerStarted && m_synchronizer.hasCaughtUpSubscriptions()) {
+    stopBlockchainSynchronizer();
+    m_synchronizer.mergeCaughtUpSubscriptions();
+    startBlockchainSynchronizer();
+  }
 }
 
 void WalletGreen::onBlocksAdded(const Crypto::PublicKey& viewPublicKey, const std::vector<Crypto::Hash>& blockHashes) {
@@ -2703,6 +2940,12 @@ void WalletGreen::transactionUpdated(const TransactionInformation& transactionIn
 }
 
 void WalletGreen::pushEvent(const WalletEvent& event) {
+  if (event.type == WalletEventType::TRANSACTION_CREATED) {
+    m_unsavedTransactions.insert(event.transactionCreated.transactionIndex);
+  } else if (event.type == WalletEventType::TRANSACTION_UPDATED) {
+    m_unsavedTransactions.insert(event.transactionUpdated.transactionIndex);
+  }
+
   m_events.push(event);
   m_eventOccurred.set();
 }
@@ -20,6 +20,7 @@
 #include "IWallet.h"
 
 #include <queue>
+#include <set>
 #include <unordered_map>
 
 #include "IFusionManager.h"
@@ -300,6 +301,12 @@ protected:
   void loadContainerStorage(const std::string& path);
   void loadWalletCache(std::unordered_set<Crypto::PublicKey>& addedKeys, std::unordered_set<Crypto::PublicKey>& deletedKeys, std::string& extra);
   void saveWalletCache(ContainerStorage& storage, const Crypto::chacha8_key& key, WalletSaveLevel saveLevel, const std::string& extra);
+  bool canSaveWalletJournal() const;
+  void saveWalletJournal(const std::string& extra);
+  void loadWalletJournal(const std::string& path, std::string& extra);
+  void resetWalletJournal(WalletSaveLevel saveLevel);
+  void closeWalletJournal();
+  void markWalletCacheSaved();
   void subscribeWallets();
 
   std::vector<OutputToTransfer> pickRandomFusionInputs(const std::vector<std::string>& addresses,
@@ -347,6 +354,11 @@ protected:
   mutable std::unordered_map<size_t, bool> m_fusionTxsCache; // txIndex -> isFusion
   UncommitedTransactions m_uncommitedTransactions;
 
+  WalletJournalStorage m_journal;
+  bool m_journalEnabled; // save() may append a journal record instead of rewriting the cache
+  std::set<size_t> m_unsavedTransactions; // transactions changed since the last save
+  std::unordered_map<Crypto::PublicKey, std::pair<uint64_t, uint64_t>> m_savedBalances; // spend key -> (actual, pending) at the last save
+
   bool m_blockchainSynchronizerStarted;
   BlockchainSynchronizer m_blockchainSynchronizer;
   TransfersSyncronizer m_synchronizer;
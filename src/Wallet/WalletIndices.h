@@ -109,6 +109,7 @@ typedef boost::multi_index_container <
 > WalletTransactions;
 
 typedef Common::FileMappedVector<EncryptedWalletRecord> ContainerStorage;
+typedef Common::FileMappedVector<uint8_t> WalletJournalStorage;
 typedef std::pair<size_t, CryptoNote::WalletTransfer> TransactionTransferPair;
 typedef std::vector<TransactionTransferPair> WalletTransfers;
 typedef std::map<size_t, CryptoNote::Transaction> UncommitedTransactions;
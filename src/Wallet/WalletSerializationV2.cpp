@@ -79,6 +79,39 @@ struct WalletTransferDtoV2 {
   uint8_t type;
 };
 
+struct TransactionTransferIdLess {
+  bool operator()(const CryptoNote::TransactionTransferPair& pair, size_t transactionId) const {
+    return pair.first < transactionId;
+  }
+
+  bool operator()(size_t transactionId, const CryptoNote::TransactionTransferPair& pair) const {
+    return transactionId < pair.first;
+  }
+};
+
+CryptoNote::WalletTransaction toWalletTransaction(const WalletTransactionDtoV2& dto) {
+  CryptoNote::WalletTransaction tx;
+  tx.state = dto.state;
+  tx.timestamp = dto.timestamp;
+  tx.blockHeight = dto.blockHeight;
+  tx.hash = dto.hash;
+  tx.totalAmount = dto.totalAmount;
+  tx.fee = dto.fee;
+  tx.creationTime = dto.creationTime;
+  tx.unlockTime = dto.unlockTime;
+  tx.extra = dto.extra;
+  tx.isBase = dto.isBase;
+  return tx;
+}
+
+CryptoNote::WalletTransfer toWalletTransfer(const WalletTransferDtoV2& dto) {
+  CryptoNote::WalletTransfer tr;
+  tr.address = dto.address;
+  tr.amount = dto.amount;
+  tr.type = static_cast<CryptoNote::WalletTransferType>(dto.type);
+  return tr;
+}
+
 void serialize(UnlockTransactionJobDtoV2& value, CryptoNote::ISerializer& serializer) {
   serializer(value.blockHeight, "blockHeight");
   serializer(value.transactionHash, "transactionHash");
@@ -187,6 +220,71 @@ void WalletSerializerV2::save(Common::IOutputStream& destination, WalletSaveLeve
   s(m_extra, "extra");
 }
 
+void WalletSerializerV2::saveJournalRecord(Common::IOutputStream& destination, const std::vector<Crypto::PublicKey>& changedWallets,
+  const std::set<size_t>& changedTransactions) {
+
+  CryptoNote::BinaryOutputStreamSerializer s(destination);
+
+  auto& index = m_walletsContainer.get<KeysIndex>();
+  uint64_t walletCount = changedWallets.size();
+  s(walletCount, "walletCount");
+
+  for (auto spendPublicKey : changedWallets) {
+    auto it = index.find(spendPublicKey);
+    assert(it != index.end());
+
+    uint64_t actualBalance = it->actualBalance;
+    uint64_t pendingBalance = it->pendingBalance;
+    s(spendPublicKey, "spendPublicKey");
+    s(actualBalance, "actualBalance");
+    s(pendingBalance, "pendingBalance");
+  }
+
+  saveJournalTransactions(s, changedTransactions);
+  saveTransfersSynchronizerChanges(s);
+  saveUnlockTransactionsJobs(s);
+  saveJournalUncommitedTransactions(s);
+
+  s(m_extra, "extra");
+}
+
+void WalletSerializerV2::loadJournalRecord(Common::IInputStream& source) {
+  CryptoNote::BinaryInputStreamSerializer s(source);
+
+  auto& index = m_walletsContainer.get<KeysIndex>();
+  uint64_t walletCount = 0;
+  s(walletCount, "walletCount");
+
+  for (uint64_t i = 0; i < walletCount; ++i) {
+    Crypto::PublicKey spendPublicKey;
+    uint64_t actualBalance;
+    uint64_t pendingBalance;
+    s(spendPublicKey, "spendPublicKey");
+    s(actualBalance, "actualBalance");
+    s(pendingBalance, "pendingBalance");
+
+    auto it = index.find(spendPublicKey);
+    if (it != index.end()) {
+      m_actualBalance = m_actualBalance - it->actualBalance + actualBalance;
+      m_pendingBalance = m_pendingBalance - it->pendingBalance + pendingBalance;
+
+      index.modify(it, [actualBalance, pendingBalance](WalletRecord& wallet) {
+        wallet.actualBalance = actualBalance;
+        wallet.pendingBalance = pendingBalance;
+      });
+    }
+  }
+
+  loadJournalTransactions(s);
+  loadTransfersSynchronizerChanges(s);
+
+  m_unlockTransactions.clear();
+  loadUnlockTransactionsJobs(s);
+  loadJournalUncommitedTransactions(s);
+
+  s(m_extra, "extra");
+}
+
 std::unordered_set<Crypto::PublicKey>& WalletSerializerV2::addedKeys() {
   return m_addedKeys;
 }
@@ -262,19 +360,7 @@ void WalletSerializerV2::loadTransactions(CryptoNote::ISerializer& serializer) {
     WalletTransactionDtoV2 dto;
     serializer(dto, "transaction");
 
-    WalletTransaction tx;
-    tx.state = dto.state;
-    tx.timestamp = dto.timestamp;
-    tx.blockHeight = dto.blockHeight;
-    tx.hash = dto.hash;
-    tx.totalAmount = dto.totalAmount;
-    tx.fee = dto.fee;
-    tx.creationTime = dto.creationTime;
-    tx.unlockTime = dto.unlockTime;
-    tx.extra = dto.extra;
-    tx.isBase = dto.isBase;
-
-    m_transactions.get<RandomAccessIndex>().emplace_back(std::move(tx));
+    m_transactions.get<RandomAccessIndex>().emplace_back(toWalletTransaction(dto));
   }
 }
 
@@ -301,12 +387,7 @@ void WalletSerializerV2::loadTransfers(CryptoNote::ISerializer& serializer) {
     WalletTransferDtoV2 dto;
     serializer(dto, "transfer");
 
-    WalletTransfer tr;
-    tr.address = dto.address;
-    tr.amount = dto.amount;
-    tr.type = static_cast<WalletTransferType>(dto.type);
-
-    m_transfers.emplace_back(std::piecewise_construct, std::forward_as_tuple(txId), std::forward_as_tuple(std::move(tr)));
+    m_transfers.emplace_back(std::piecewise_construct, std::forward_as_tuple(txId), std::forward_as_tuple(toWalletTransfer(dto)));
   }
 }
 
@@ -341,6 +422,23 @@ void WalletSerializerV2::saveTransfersSynchronizer(CryptoNote::ISerializer& seri
   serializer(transfersSynchronizerData, "transfersSynchronizer");
 }
 
+void WalletSerializerV2::loadTransfersSynchronizerChanges(CryptoNote::ISerializer& serializer) {
+  std::string changesData;
+  serializer(changesData, "transfersSynchronizerChanges");
+
+  std::stringstream stream(changesData);
+  m_synchronizer.loadChanges(stream);
+}
+
+void WalletSerializerV2::saveTransfersSynchronizerChanges(CryptoNote::ISerializer& serializer) {
+  std::stringstream stream;
+  m_synchronizer.saveChanges(stream);
+  stream.flush();
+
+  std::string changesData = stream.str();
+  serializer(changesData, "transfersSynchronizerChanges");
+}
+
 void WalletSerializerV2::loadUnlockTransactionsJobs(CryptoNote::ISerializer& serializer) {
   auto& index = m_unlockTransactions.get<TransactionHashIndex>();
   auto& walletsIndex = m_walletsContainer.get<KeysIndex>();
@@ -387,4 +485,101 @@ void WalletSerializerV2::saveUnlockTransactionsJobs(CryptoNote::ISerializer& ser
   }
 }
 
+void WalletSerializerV2::loadJournalTransactions(CryptoNote::ISerializer& serializer) {
+  auto& idIndex = m_transactions.get<RandomAccessIndex>();
+  auto& hashIndex = m_transactions.get<TransactionIndex>();
+
+  uint64_t count = 0;
+  serializer(count, "transactionCount");
+
+  for (uint64_t i = 0; i < count; ++i) {
+    WalletTransactionDtoV2 dto;
+    serializer(dto, "transaction");
+
+    size_t txId;
+    auto it = hashIndex.find(dto.hash);
+    if (it != hashIndex.end()) {
+      txId = std::distance(idIndex.begin(), m_transactions.project<RandomAccessIndex>(it));
+      hashIndex.replace(it, toWalletTransaction(dto));
+    } else {
+      txId = idIndex.size();
+      idIndex.emplace_back(toWalletTransaction(dto));
+    }
+
+    uint64_t transferCount = 0;
+    serializer(transferCount, "transferCount");
+
+    WalletTransfers transfers;
+    transfers.reserve(transferCount);
+    for (uint64_t j = 0; j < transferCount; ++j) {
+      WalletTransferDtoV2 transferDto;
+      serializer(transferDto, "transfer");
+      transfers.emplace_back(txId, toWalletTransfer(transferDto));
+    }
+
+    auto range = std::equal_range(m_transfers.begin(), m_transfers.end(), txId, TransactionTransferIdLess());
+    auto insertIt = m_transfers.erase(range.first, range.second);
+    m_transfers.insert(insertIt, transfers.begin(), transfers.end());
+  }
+}
+
+void WalletSerializerV2::saveJournalTransactions(CryptoNote::ISerializer& serializer, const std::set<size_t>& changedTransactions) {
+  auto& idIndex = m_transactions.get<RandomAccessIndex>();
+
+  uint64_t count = changedTransactions.size();
+  serializer(count, "transactionCount");
+
+  for (auto txId : changedTransactions) {
+    assert(txId < idIndex.size());
+    WalletTransactionDtoV2 dto(idIndex[txId]);
+    serializer(dto, "transaction");
+
+    auto range = std::equal_range(m_transfers.begin(), m_transfers.end(), txId, TransactionTransferIdLess());
+    uint64_t transferCount = std::distance(range.first, range.second);
+    serializer(transferCount, "transferCount");
+
+    for (auto it = range.first; it != range.second; ++it) {
+      WalletTransferDtoV2 tr(it->second);
+      serializer(tr, "transfer");
+    }
+  }
+}
+
+void WalletSerializerV2::loadJournalUncommitedTransactions(CryptoNote::ISerializer& serializer) {
+  auto& idIndex = m_transactions.get<RandomAccessIndex>();
+  auto& hashIndex = m_transactions.get<TransactionIndex>();
+
+  m_uncommitedTransactions.clear();
+
+  uint64_t count = 0;
+  serializer(count, "uncommitedTransactionCount");
+
+  for (uint64_t i = 0; i < count; ++i) {
+    Hash transactionHash;
+    CryptoNote::Transaction transaction;
+    serializer(transactionHash, "transactionHash");
+    serializer(transaction, "transaction");
+
+    auto it = hashIndex.find(transactionHash);
+    if (it != hashIndex.end()) {
+      size_t txId = std::distance(idIndex.begin(), m_transactions.project<RandomAccessIndex>(it));
+      m_uncommitedTransactions.emplace(txId, std::move(transaction));
+    }
+  }
+}
+
+void WalletSerializerV2::saveJournalUncommitedTransactions(CryptoNote::ISerializer& serializer) {
+  auto& idIndex = m_transactions.get<RandomAccessIndex>();
+
+  uint64_t count = m_uncommitedTransactions.size();
+  serializer(count, "uncommitedTransactionCount");
+
+  for (auto& kv : m_uncommitedTransactions) {
+    assert(kv.first < idIndex.size());
+    Hash transactionHash = idIndex[kv.first].hash;
+    serializer(transactionHash, "transactionHash");
+    serializer(kv.second, "transaction");
+  }
+}
+
 } //namespace CryptoNote
@@ -17,6 +17,9 @@
 
 #pragma once
 
+#include <set>
+#include <vector>
+
 #include "Common/IInputStream.h"
 #include "Common/IOutputStream.h"
 #include "Serialization/ISerializer.h"
@@ -46,6 +49,11 @@ public:
   void load(Common::IInputStream& source, uint8_t version);
   void save(Common::IOutputStream& destination, WalletSaveLevel saveLevel);
 
+  // Journal records hold only the part of the cache changed since the previous save.
+  // Transactions are matched by hash, so records stay valid when the snapshot renumbers them
+  void saveJournalRecord(Common::IOutputStream& destination, const std::vector<Crypto::PublicKey>& changedWallets, const std::set<size_t>& changedTransactions);
+  void loadJournalRecord(Common::IInputStream& source);
+
   std::unordered_set<Crypto::PublicKey>& addedKeys();
   std::unordered_set<Crypto::PublicKey>& deletedKeys();
 
@@ -64,10 +72,18 @@ private:
 
   void loadTransfersSynchronizer(CryptoNote::ISerializer& serializer);
   void saveTransfersSynchronizer(CryptoNote::ISerializer& serializer);
+  void loadTransfersSynchronizerChanges(CryptoNote::ISerializer& serializer);
+  void saveTransfersSynchronizerChanges(CryptoNote::ISerializer& serializer);
 
   void loadUnlockTransactionsJobs(CryptoNote::ISerializer& serializer);
   void saveUnlockTransactionsJobs(CryptoNote::ISerializer& serializer);
 
+  void loadJournalTransactions(CryptoNote::ISerializer& serializer);
+  void saveJournalTransactions(CryptoNote::ISerializer& serializer, const std::set<size_t>& changedTransactions);
+
+  void loadJournalUncommitedTransactions(CryptoNote::ISerializer& serializer);
+  void saveJournalUncommitedTransactions(CryptoNote::ISerializer& serializer);
+
   ITransfersObserver& m_transfersObserver;
   uint64_t& m_actualBalance;
   uint64_t& m_pendingBalance;
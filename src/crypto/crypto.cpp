@@ -22,7 +22,6 @@
 #include <cstdlib>
 #include <cstring>
 #include <memory>
-#include <mutex>
 
 #include "Common/Varint.h"
 #include "crypto.h"
@@ -32,16 +31,12 @@ namespace Crypto {
 
   using std::abort;
   using std::int32_t;
-  using std::lock_guard;
-  using std::mutex;
 
   extern "C" {
 #include "crypto-ops.h"
 #include "random.h"
   }
 
-  mutex random_lock;
-
   static inline void random_scalar(EllipticCurveScalar &res) {
     unsigned char tmp[64];
     generate_random_bytes(64, tmp);
@@ -55,7 +50,6 @@ namespace Crypto {
   }
 
   void crypto_ops::generate_keys(PublicKey &pub, SecretKey &sec) {
-    lock_guard<mutex> lock(random_lock);
     ge_p3 point;
     random_scalar(reinterpret_cast<EllipticCurveScalar&>(sec));
     ge_scalarmult_base(&point, reinterpret_cast<unsigned char*>(&sec));
@@ -244,7 +238,6 @@ namespace Crypto {
   };
 
   void crypto_ops::generate_signature(const Hash &prefix_hash, const PublicKey &pub, const SecretKey &sec, Signature &sig) {
-    lock_guard<mutex> lock(random_lock);
     ge_p3 tmp3;
     EllipticCurveScalar k;
     s_comm buf;
@@ -355,7 +348,6 @@ namespace Crypto {
     const PublicKey *const *pubs, size_t pubs_count,
     const SecretKey &sec, size_t sec_index,
     Signature *sig) {
-    lock_guard<mutex> lock(random_lock);
     size_t i;
     ge_p3 image_unp;
     ge_dsmp image_pre;
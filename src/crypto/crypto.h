@@ -19,7 +19,6 @@
 
 #include <cstddef>
 #include <limits>
-#include <mutex>
 #include <type_traits>
 #include <vector>
 
@@ -34,8 +33,6 @@ namespace Crypto {
 #include "random.h"
   }
 
-  extern std::mutex random_lock;
-
 struct EllipticCurvePoint {
   uint8_t data[32];
 };
@@ -101,7 +98,6 @@ struct EllipticCurveScalar {
   template<typename T>
   typename std::enable_if<std::is_pod<T>::value, T>::type rand() {
     typename std::remove_cv<T>::type res;
-    std::lock_guard<std::mutex> lock(random_lock);
     generate_random_bytes(sizeof(T), &res);
     return res;
   }
@@ -122,11 +118,11 @@ struct EllipticCurveScalar {
       return (std::numeric_limits<T>::max)();
     }
 #else
-    static T(min)() {
+    constexpr static T(min)() {
       return (std::numeric_limits<T>::min)();
     }
 
-    static T(max)() {
+    constexpr static T(max)() {
       return (std::numeric_limits<T>::max)();
     }
 #endif
@@ -79,52 +79,82 @@ static void generate_system_random_bytes(size_t n, void *result) {
 
 #endif
 
-static union hash_state state;
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
+/* Every thread has a generator state of its own, so generating random bytes takes no lock.
+ * The state is seeded from the system generator on the first use in a thread, in a child process
+ * after fork() and then after every RESEED_INTERVAL permutations.
+ */
+enum {
+  RESEED_INTERVAL = 1 << 16
+};
+
+struct random_state {
+  union hash_state state;
+  unsigned int generation;
+  unsigned int permutations;
+  int seeded;
+};
+
+static THREAD_LOCAL struct random_state thread_state;
+static unsigned int fork_generation;
 
-#if !defined(NDEBUG)
-static volatile int curstate; /* To catch thread safety problems. */
+#if !defined(_WIN32)
+#include <pthread.h>
+
+static void on_fork_child(void) {
+  /* The child is single-threaded here, it inherited a copy of the parent thread state */
+  ++fork_generation;
+}
 #endif
 
+static void reseed(struct random_state *state) {
+  uint8_t seed[32];
+  size_t i;
+  generate_system_random_bytes(sizeof(seed), seed);
+  /* Mix the seed into the current state instead of replacing it */
+  for (i = 0; i < sizeof(seed); ++i) {
+    state->state.b[i] ^= seed[i];
+  }
+  memset(seed, 0, sizeof(seed));
+  state->generation = fork_generation;
+  state->permutations = 0;
+  state->seeded = 1;
+}
+
 FINALIZER(deinit_random) {
-#if !defined(NDEBUG)
-  assert(curstate == 1);
-  curstate = 0;
-#endif
-  memset(&state, 0, sizeof(union hash_state));
+  memset(&thread_state, 0, sizeof(struct random_state));
 }
 
 INITIALIZER(init_random) {
-  generate_system_random_bytes(32, &state);
-  REGISTER_FINALIZER(deinit_random);
-#if !defined(NDEBUG)
-  assert(curstate == 0);
-  curstate = 1;
+#if !defined(_WIN32)
+  if (pthread_atfork(NULL, NULL, on_fork_child) != 0) {
+    errx(EXIT_FAILURE, "pthread_atfork");
+  }
 #endif
+  REGISTER_FINALIZER(deinit_random);
 }
 
 void generate_random_bytes(size_t n, void *result) {
-#if !defined(NDEBUG)
-  assert(curstate == 1);
-  curstate = 2;
-#endif
+  struct random_state *state = &thread_state;
   if (n == 0) {
-#if !defined(NDEBUG)
-    assert(curstate == 2);
-    curstate = 1;
-#endif
     return;
   }
+  if (!state->seeded || state->generation != fork_generation || state->permutations >= RESEED_INTERVAL) {
+    reseed(state);
+  }
   for (;;) {
-    hash_permutation(&state);
+    hash_permutation(&state->state);
+    ++state->permutations;
     if (n <= HASH_DATA_AREA) {
-      memcpy(result, &state, n);
-#if !defined(NDEBUG)
-      assert(curstate == 2);
-      curstate = 1;
-#endif
+      memcpy(result, &state->state, n);
       return;
     } else {
-      memcpy(result, &state, HASH_DATA_AREA);
+      memcpy(result, &state->state, HASH_DATA_AREA);
       result = padd(result, HASH_DATA_AREA);
       n -= HASH_DATA_AREA;
     }
@@ -37,6 +37,18 @@ uint32_t VectorMainChainStorage::getBlockCount() const {
   return static_cast<uint32_t>(storage.size());
 }
 
+uint64_t VectorMainChainStorage::getBlockOffset(uint32_t index) const {
+  if (index >= storage.size()) {
+    throw std::out_of_range("Block index " + std::to_string(index) + " is out of range");
+  }
+
+  return index;
+}
+
+RawBlock VectorMainChainStorage::getBlockByOffset(uint64_t offset) const {
+  return storage.at(static_cast<size_t>(offset));
+}
+
 void VectorMainChainStorage::clear() {
   storage.clear();
 }
@@ -30,6 +30,8 @@ public:
   virtual void popBlock() override;
   virtual RawBlock getBlockByIndex(uint32_t index) const override;
   virtual uint32_t getBlockCount() const override;
+  virtual uint64_t getBlockOffset(uint32_t index) const override;
+  virtual RawBlock getBlockByOffset(uint64_t offset) const override;
   virtual void clear() override;
 
 private:
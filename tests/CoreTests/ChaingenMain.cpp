@@ -31,6 +31,8 @@
 #include "TransactionValidation.h"
 #include "Upgrade.h"
 #include "RandomOuts.h"
+#include "QueryBlocksScan.h"
+#include "ImportBlocks.h"
 
 namespace po = boost::program_options;
 
@@ -82,6 +84,8 @@ int main(int argc, char* argv[]) {
 
       GENERATE_AND_PLAY(GetRandomOutputs);
       GENERATE_AND_PLAY(gen_chain_switch_1);
+      GENERATE_AND_PLAY(gen_query_blocks_scan);
+      GENERATE_AND_PLAY(gen_import_blocks);
       GENERATE_AND_PLAY(gen_block_reward);
       GENERATE_AND_PLAY(gen_ring_signature_1);
       GENERATE_AND_PLAY(gen_ring_signature_2);
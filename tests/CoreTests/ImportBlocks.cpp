@@ -0,0 +1,88 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "ImportBlocks.h"
+
+#include <thread>
+
+using namespace CryptoNote;
+
+gen_import_blocks::gen_import_blocks() {
+  REGISTER_CALLBACK("check_import", gen_import_blocks::check_import);
+}
+
+//-----------------------------------------------------------------------------------------------------
+bool gen_import_blocks::generate(std::vector<test_event_entry>& events) const {
+  GENERATE_ACCOUNT(miner_account);
+
+  MAKE_GENESIS_BLOCK(events, blk_0, miner_account, ts_start);
+  MAKE_ACCOUNT(events, recipient_account);
+  REWIND_BLOCKS(events, blk_0r, blk_0, miner_account);
+  MAKE_TX(events, tx_0, miner_account, recipient_account, MK_COINS(5), blk_0r);
+  MAKE_NEXT_BLOCK_TX1(events, blk_1, blk_0r, miner_account, tx_0);
+  // enough blocks for the import to go through several decoding chunks
+  REWIND_BLOCKS_N(events, blk_2, blk_1, miner_account, 600);
+  DO_CALLBACK(events, "check_import");
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------------------------------
+bool gen_import_blocks::check_import(CryptoNote::Core& c, size_t ev_index, const std::vector<test_event_entry>& events) {
+  DEFINE_TESTS_ERROR_CONTEXT("gen_import_blocks::check_import");
+
+  auto storage = createVectorMainChainStorage(*m_currency);
+  for (auto& rawBlock : c.getBlocks(1, c.getTopBlockIndex())) {
+    storage->pushBlock(rawBlock);
+  }
+
+  CHECK_EQ(c.getTopBlockIndex() + 1, storage->getBlockCount());
+
+  Crypto::Hash importedTopBlockHash;
+  size_t importedTransactionCount = 0;
+  CoreStatistics statistics;
+  std::string error;
+
+  // the imported core needs a dispatcher of its own
+  std::thread importThread([&] {
+    try {
+      System::Dispatcher dispatcher;
+      DataBaseMock database;
+      Core importedCore(*m_currency, m_logger, Checkpoints(m_logger), dispatcher,
+        std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(database, m_logger)), std::move(storage));
+      importedCore.load();
+
+      importedTopBlockHash = importedCore.getTopBlockHash();
+      importedTransactionCount = importedCore.getBlockchainTransactionCount();
+      statistics = importedCore.getCoreStatistics();
+    } catch (std::exception& e) {
+      error = e.what();
+    }
+  });
+
+  importThread.join();
+
+  CHECK_TEST_CONDITION(error.empty());
+  CHECK_TEST_CONDITION(importedTopBlockHash == c.getTopBlockHash());
+  CHECK_EQ(c.getBlockchainTransactionCount(), importedTransactionCount);
+  CHECK_EQ(c.getTopBlockIndex(), statistics.importedBlockCount);
+  CHECK_EQ(c.getTopBlockIndex(), statistics.importBlockCount);
+  CHECK_EQ(0, statistics.importEtaSeconds);
+  CHECK_EQ(c.getTopBlockIndex() + 1, statistics.blockchainHeight);
+
+  return true;
+}
@@ -0,0 +1,151 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "QueryBlocksScan.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+bool checkTransactionScanInfo(CryptoNote::Core& c, const Transaction& tx, const TransactionScanInfo& scanInfo) {
+  DEFINE_TESTS_ERROR_CONTEXT("gen_query_blocks_scan::checkTransactionScanInfo");
+
+  CHECK_TEST_CONDITION(getObjectHash(tx) == scanInfo.txHash);
+  CHECK_TEST_CONDITION(getTransactionPublicKeyFromExtra(tx.extra) == scanInfo.txPublicKey);
+  CHECK_EQ(tx.unlockTime, scanInfo.unlockTime);
+
+  std::vector<uint32_t> globalIndexes;
+  CHECK_TEST_CONDITION(c.getTransactionGlobalIndexes(scanInfo.txHash, globalIndexes));
+
+  // every output keeps its position, only key outputs exist in this chain
+  CHECK_EQ(tx.outputs.size(), scanInfo.outputs.size());
+  CHECK_EQ(tx.outputs.size(), globalIndexes.size());
+  for (size_t i = 0; i < tx.outputs.size(); ++i) {
+    CHECK_EQ(tx.outputs[i].amount, scanInfo.outputs[i].amount);
+    CHECK_TEST_CONDITION(boost::get<KeyOutput>(tx.outputs[i].target).key == scanInfo.outputs[i].key);
+    CHECK_EQ(globalIndexes[i], scanInfo.outputs[i].globalIndex);
+  }
+
+  std::vector<Crypto::KeyImage> keyImages;
+  for (const auto& input : tx.inputs) {
+    if (input.type() == typeid(KeyInput)) {
+      keyImages.push_back(boost::get<KeyInput>(input).keyImage);
+    }
+  }
+
+  CHECK_TEST_CONDITION(keyImages == scanInfo.keyImages);
+  return true;
+}
+
+}
+
+gen_query_blocks_scan::gen_query_blocks_scan() {
+  REGISTER_CALLBACK("check_scan_info", gen_query_blocks_scan::check_scan_info);
+  REGISTER_CALLBACK("check_switched_scan_info", gen_query_blocks_scan::check_switched_scan_info);
+}
+
+//-----------------------------------------------------------------------------------------------------
+bool gen_query_blocks_scan::generate(std::vector<test_event_entry>& events) const {
+  /*
+  (0 )-<N>-(1 )-(2 )                  <- main chain before switch
+                 \-(3 )-(4 )          <- alt chain, becomes main after (4)
+  */
+
+  GENERATE_ACCOUNT(miner_account);
+
+  MAKE_GENESIS_BLOCK(events, blk_0, miner_account, ts_start);
+  MAKE_ACCOUNT(events, recipient_account);
+  REWIND_BLOCKS(events, blk_0r, blk_0, miner_account);
+  MAKE_TX(events, tx_0, miner_account, recipient_account, MK_COINS(5), blk_0r);
+  MAKE_NEXT_BLOCK_TX1(events, blk_1, blk_0r, miner_account, tx_0);
+  MAKE_NEXT_BLOCK(events, blk_2, blk_1, miner_account);
+  DO_CALLBACK(events, "check_scan_info");
+
+  MAKE_TX(events, tx_1, miner_account, recipient_account, MK_COINS(7), blk_1);
+  MAKE_NEXT_BLOCK_TX1(events, blk_3, blk_1, miner_account, tx_1);
+  MAKE_NEXT_BLOCK(events, blk_4, blk_3, miner_account);
+  DO_CALLBACK(events, "check_switched_scan_info");
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------------------------------
+bool gen_query_blocks_scan::check_scan_info(CryptoNote::Core& c, size_t ev_index, const std::vector<test_event_entry>& events) {
+  DEFINE_TESTS_ERROR_CONTEXT("gen_query_blocks_scan::check_scan_info");
+
+  m_replacedBlockHash = c.getTopBlockHash();
+  CHECK_TEST_CONDITION(checkScanInfoMatchesChain(c));
+  return true;
+}
+
+//-----------------------------------------------------------------------------------------------------
+bool gen_query_blocks_scan::check_switched_scan_info(CryptoNote::Core& c, size_t ev_index, const std::vector<test_event_entry>& events) {
+  DEFINE_TESTS_ERROR_CONTEXT("gen_query_blocks_scan::check_switched_scan_info");
+
+  // blk_2 was served before the switch, its cached entry must not outlive it
+  CHECK_TEST_CONDITION(c.getBlockHashByIndex(c.getTopBlockIndex() - 1) != m_replacedBlockHash);
+  CHECK_TEST_CONDITION(checkScanInfoMatchesChain(c));
+  return true;
+}
+
+//-----------------------------------------------------------------------------------------------------
+bool gen_query_blocks_scan::checkScanInfoMatchesChain(CryptoNote::Core& c) {
+  DEFINE_TESTS_ERROR_CONTEXT("gen_query_blocks_scan::checkScanInfoMatchesChain");
+
+  uint32_t startIndex = 0;
+  uint32_t currentIndex = 0;
+  uint32_t fullOffset = 0;
+  std::vector<BlockScanInfo> entries;
+  CHECK_TEST_CONDITION(c.queryBlocksScan({c.getBlockHashByIndex(0)}, 0, startIndex, currentIndex, fullOffset, entries));
+
+  CHECK_EQ(0, startIndex);
+  CHECK_TEST_CONDITION(fullOffset <= currentIndex);
+  CHECK_EQ(c.getTopBlockIndex(), currentIndex);
+  CHECK_EQ(currentIndex + 1, entries.size());
+
+  auto rawBlocks = c.getBlocks(0, static_cast<uint32_t>(entries.size()));
+  CHECK_EQ(entries.size(), rawBlocks.size());
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    BlockTemplate block;
+    CHECK_TEST_CONDITION(fromBinaryArray(block, rawBlocks[i].block));
+
+    const auto& entry = entries[i];
+    CHECK_TEST_CONDITION(getBlockHash(block) == entry.blockId);
+
+    // blocks below the full offset are sent as bare hashes
+    if (i < fullOffset) {
+      CHECK_TEST_CONDITION(entry.transactions.empty());
+      continue;
+    }
+
+    CHECK_EQ(block.timestamp, entry.timestamp);
+
+    // coinbase goes first, then the block transactions in block order
+    CHECK_EQ(block.transactionHashes.size() + 1, entry.transactions.size());
+    CHECK_TEST_CONDITION(checkTransactionScanInfo(c, block.baseTransaction, entry.transactions[0]));
+
+    for (size_t j = 0; j < rawBlocks[i].transactions.size(); ++j) {
+      Transaction tx;
+      CHECK_TEST_CONDITION(fromBinaryArray(tx, rawBlocks[i].transactions[j]));
+      CHECK_TEST_CONDITION(block.transactionHashes[j] == entry.transactions[j + 1].txHash);
+      CHECK_TEST_CONDITION(checkTransactionScanInfo(c, tx, entry.transactions[j + 1]));
+    }
+  }
+
+  return true;
+}
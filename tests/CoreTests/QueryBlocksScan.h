@@ -0,0 +1,37 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+#include "Chaingen.h"
+
+/************************************************************************/
+/*                                                                      */
+/************************************************************************/
+class gen_query_blocks_scan : public test_chain_unit_base {
+public:
+  gen_query_blocks_scan();
+
+  bool generate(std::vector<test_event_entry>& events) const;
+
+  bool check_scan_info(CryptoNote::Core& c, size_t ev_index, const std::vector<test_event_entry>& events);
+  bool check_switched_scan_info(CryptoNote::Core& c, size_t ev_index, const std::vector<test_event_entry>& events);
+
+private:
+  bool checkScanInfoMatchesChain(CryptoNote::Core& c);
+
+  Crypto::Hash m_replacedBlockHash;
+};
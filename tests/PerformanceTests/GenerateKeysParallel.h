@@ -0,0 +1,104 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "crypto/crypto.h"
+
+#include "PerformanceUtils.h"
+
+// Every thread generates its own keys, measures contention on the random generator
+template<size_t thread_count>
+class test_generate_keys_parallel
+{
+public:
+  static const size_t loop_count = 10;
+  static const size_t keys_per_thread = 1000;
+
+  bool init()
+  {
+    return true;
+  }
+
+  bool test()
+  {
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+      threads.emplace_back([i] {
+        // the main thread is pinned to a single core, spread the workers over all of them
+        set_process_affinity(static_cast<int>(i % std::max(1u, std::thread::hardware_concurrency())));
+
+        Crypto::PublicKey publicKey;
+        Crypto::SecretKey secretKey;
+        for (size_t j = 0; j < keys_per_thread; ++j)
+        {
+          Crypto::generate_keys(publicKey, secretKey);
+        }
+      });
+    }
+
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+
+    return true;
+  }
+};
+
+// Random bytes only, as consumed by Crypto::random_engine and ShuffleGenerator
+template<size_t thread_count>
+class test_crypto_rand_parallel
+{
+public:
+  static const size_t loop_count = 10;
+  static const size_t values_per_thread = 100000;
+
+  bool init()
+  {
+    return true;
+  }
+
+  bool test()
+  {
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+      threads.emplace_back([i] {
+        set_process_affinity(static_cast<int>(i % std::max(1u, std::thread::hardware_concurrency())));
+
+        volatile uint64_t value = 0;
+        for (size_t j = 0; j < values_per_thread; ++j)
+        {
+          value = value + Crypto::rand<uint64_t>();
+        }
+      });
+    }
+
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+
+    return true;
+  }
+};
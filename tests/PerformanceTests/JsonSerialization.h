@@ -0,0 +1,149 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <vector>
+
+#include "BlockchainExplorerData.h"
+#include "Common/JsonValue.h"
+#include "Serialization/BlockchainExplorerDataSerialization.h"
+#include "Serialization/JsonInputBufferSerializer.h"
+#include "Serialization/JsonInputValueSerializer.h"
+#include "Serialization/JsonOutputBufferSerializer.h"
+#include "Serialization/JsonOutputStreamSerializer.h"
+#include "Serialization/SerializationOverloads.h"
+
+// Compares JsonValue based serializers (false) with buffer based ones (true) on an explorer-like response
+template <bool useBufferSerializers>
+class test_json_serialization_base
+{
+public:
+  static const size_t blocks_count = 10;
+  static const size_t transactions_count = 20;
+  static const size_t inputs_count = 10;
+  static const size_t outputs_count = 10;
+
+  struct BlocksHolder {
+    std::vector<CryptoNote::BlockDetails> blocks;
+
+    void serialize(CryptoNote::ISerializer& s) {
+      s(blocks, "blocks");
+    }
+  };
+
+  bool init()
+  {
+    for (uint32_t i = 0; i < blocks_count; ++i) {
+      CryptoNote::BlockDetails block;
+      block.index = i;
+      block.timestamp = 1500000000 + i;
+      block.difficulty = 1000000 + i;
+      block.reward = 1000000000000;
+      block.penalty = 0.5;
+
+      for (size_t j = 0; j < transactions_count; ++j) {
+        CryptoNote::TransactionDetails transaction;
+        transaction.fee = 1000000 + j;
+        transaction.size = 2000 + j;
+        transaction.blockIndex = i;
+        transaction.extra.raw.assign(33, static_cast<uint8_t>(j));
+
+        for (size_t k = 0; k < inputs_count; ++k) {
+          CryptoNote::KeyInputDetails input;
+          input.input.amount = 100000 * k;
+          input.input.outputIndexes.assign(4, static_cast<uint32_t>(k));
+          input.mixin = 3;
+          input.output.number = k;
+          transaction.inputs.push_back(input);
+        }
+
+        transaction.signatures.resize(inputs_count, std::vector<Crypto::Signature>(4));
+
+        for (size_t k = 0; k < outputs_count; ++k) {
+          CryptoNote::TransactionOutputDetails output;
+          output.output.amount = 100000 * k;
+          output.output.target = CryptoNote::KeyOutput();
+          output.globalIndex = 1000 * k;
+          transaction.outputs.push_back(output);
+        }
+
+        block.transactions.push_back(transaction);
+      }
+
+      m_holder.blocks.push_back(block);
+    }
+
+    m_json = store();
+    return true;
+  }
+
+protected:
+  std::string store()
+  {
+    if (useBufferSerializers) {
+      CryptoNote::JsonOutputBufferSerializer s;
+      m_holder.serialize(s);
+      return s.getBuffer();
+    } else {
+      CryptoNote::JsonOutputStreamSerializer s;
+      m_holder.serialize(s);
+      return s.getValue().toString();
+    }
+  }
+
+  bool load()
+  {
+    BlocksHolder holder;
+    if (useBufferSerializers) {
+      CryptoNote::JsonInputBufferSerializer s{Common::StringView(m_json)};
+      holder.serialize(s);
+    } else {
+      CryptoNote::JsonInputValueSerializer s(Common::JsonValue::fromString(m_json));
+      holder.serialize(s);
+    }
+
+    return holder.blocks.size() == blocks_count;
+  }
+
+  BlocksHolder m_holder;
+  std::string m_json;
+};
+
+template <bool useBufferSerializers>
+class test_json_store : public test_json_serialization_base<useBufferSerializers>
+{
+public:
+  static const size_t loop_count = 50;
+
+  bool test()
+  {
+    return !this->store().empty();
+  }
+};
+
+template <bool useBufferSerializers>
+class test_json_load : public test_json_serialization_base<useBufferSerializers>
+{
+public:
+  static const size_t loop_count = 50;
+
+  bool test()
+  {
+    return this->load();
+  }
+};
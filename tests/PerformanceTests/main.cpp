@@ -27,7 +27,9 @@
 #include "GenerateKeyDerivation.h"
 #include "GenerateKeyImage.h"
 #include "GenerateKeyImageHelper.h"
+#include "GenerateKeysParallel.h"
 #include "IsOutToAccount.h"
+#include "JsonSerialization.h"
 
 int main(int argc, char** argv)
 {
@@ -72,6 +74,18 @@ int main(int argc, char** argv)
 
   TEST_PERFORMANCE0(test_cn_slow_hash);
 
+  TEST_PERFORMANCE1(test_generate_keys_parallel, 1);
+  TEST_PERFORMANCE1(test_generate_keys_parallel, 4);
+  TEST_PERFORMANCE1(test_generate_keys_parallel, 16);
+  TEST_PERFORMANCE1(test_crypto_rand_parallel, 1);
+  TEST_PERFORMANCE1(test_crypto_rand_parallel, 4);
+  TEST_PERFORMANCE1(test_crypto_rand_parallel, 16);
+
+  TEST_PERFORMANCE1(test_json_store, false);
+  TEST_PERFORMANCE1(test_json_store, true);
+  TEST_PERFORMANCE1(test_json_load, false);
+  TEST_PERFORMANCE1(test_json_load, true);
+
   std::cout << "Tests finished. Elapsed time: " << timer.elapsed_ms() / 1000 << " sec" << std::endl;
 
   return 0;
@@ -39,6 +39,14 @@ std::error_code DataBaseMock::writeSync(IWriteBatch& batch) {
   return write(batch);
 }
 
+std::error_code DataBaseMock::writeUnlogged(IWriteBatch& batch) {
+  return write(batch);
+}
+
+std::error_code DataBaseMock::flush() {
+  return{};
+}
+
 std::error_code DataBaseMock::read(IReadBatch& batch) {
   auto keys = batch.getRawKeys();
   std::vector<std::string> kvs;
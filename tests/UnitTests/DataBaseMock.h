@@ -33,6 +33,8 @@ public:
 
   std::error_code write(IWriteBatch& batch) override;
   std::error_code writeSync(IWriteBatch& batch) override;
+  std::error_code writeUnlogged(IWriteBatch& batch) override;
+  std::error_code flush() override;
   std::error_code read(IReadBatch& batch) override;
   std::unordered_map<uint32_t, RawBlock> blocks();
 
@@ -139,6 +139,12 @@ bool ICoreStub::queryBlocksLite(const std::vector<Crypto::Hash>& block_ids, uint
   return true;
 }
 
+bool ICoreStub::queryBlocksScan(const std::vector<Crypto::Hash>& block_ids, uint64_t timestamp,
+    uint32_t& start_height, uint32_t& current_height, uint32_t& full_offset, std::vector<CryptoNote::BlockScanInfo>& entries) const {
+  //stub
+  return true;
+}
+
 std::vector<Crypto::Hash> ICoreStub::buildSparseChain() const {
   std::vector<Crypto::Hash> result;
   result.reserve(blockHashByHeightIndex.size());
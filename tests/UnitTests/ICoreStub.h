@@ -74,6 +74,8 @@ public:
     uint32_t& start_height, uint32_t& current_height, uint32_t& full_offset, std::vector<CryptoNote::BlockFullInfo>& entries) const override;
   virtual bool queryBlocksLite(const std::vector<Crypto::Hash>& block_ids, uint64_t timestamp,
     uint32_t& start_height, uint32_t& current_height, uint32_t& full_offset, std::vector<CryptoNote::BlockShortInfo>& entries) const override;
+  virtual bool queryBlocksScan(const std::vector<Crypto::Hash>& block_ids, uint64_t timestamp,
+    uint32_t& start_height, uint32_t& current_height, uint32_t& full_offset, std::vector<CryptoNote::BlockScanInfo>& entries) const override;
 
   virtual bool hasBlock(const Crypto::Hash& id) const override;
   std::vector<Crypto::Hash> buildSparseChain() const override;
@@ -0,0 +1,267 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "Serialization/JsonInputBufferSerializer.h"
+#include "Serialization/JsonOutputBufferSerializer.h"
+#include "Serialization/SerializationOverloads.h"
+#include "Serialization/SerializationTools.h"
+#include "Rpc/JsonRpc.h"
+
+#include <array>
+
+using namespace CryptoNote;
+
+namespace {
+
+struct JsonTestElement {
+  std::string name;
+  uint32_t nonce;
+  int16_t delta;
+  bool flag;
+  std::array<uint8_t, 16> blob;
+  std::vector<uint32_t> u32array;
+
+  bool operator == (const JsonTestElement& other) const {
+    return
+      name == other.name &&
+      nonce == other.nonce &&
+      delta == other.delta &&
+      flag == other.flag &&
+      blob == other.blob &&
+      u32array == other.u32array;
+  }
+
+  void serialize(ISerializer& s) {
+    s(name, "name");
+    s(nonce, "nonce");
+    s(delta, "delta");
+    s(flag, "flag");
+    s.binary(blob.data(), blob.size(), "blob");
+    s(u32array, "u32array");
+  }
+};
+
+struct JsonTestStruct {
+  uint8_t u8;
+  int64_t i64;
+  uint64_t u64;
+  std::string data;
+  std::vector<JsonTestElement> vec;
+  std::vector<std::vector<JsonTestElement>> vecOfVec;
+  std::map<std::string, uint32_t> map;
+  JsonTestElement root;
+
+  bool operator == (const JsonTestStruct& other) const {
+    return
+      root == other.root &&
+      u8 == other.u8 &&
+      i64 == other.i64 &&
+      u64 == other.u64 &&
+      data == other.data &&
+      vec == other.vec &&
+      vecOfVec == other.vecOfVec &&
+      map == other.map;
+  }
+
+  void serialize(ISerializer& s) {
+    s(root, "root");
+    s(vec, "vec");
+    s(vecOfVec, "vecOfVec");
+    s(map, "map");
+    s(u8, "u8");
+    s(i64, "i64");
+    s(u64, "u64");
+    s.binary(data, "data");
+  }
+};
+
+JsonTestElement makeElement(uint32_t nonce) {
+  JsonTestElement element;
+  element.name = "element" + std::to_string(nonce);
+  element.nonce = nonce;
+  element.delta = -static_cast<int16_t>(nonce);
+  element.flag = (nonce & 1) != 0;
+  element.blob.fill(static_cast<uint8_t>(nonce));
+  element.u32array.assign(nonce % 4, nonce);
+  return element;
+}
+
+JsonTestStruct makeStruct() {
+  JsonTestStruct ts;
+  ts.u8 = 200;
+  ts.i64 = std::numeric_limits<int64_t>::min();
+  ts.u64 = std::numeric_limits<uint64_t>::max();
+  ts.data = std::string("\x00\x01\xfe\xff", 4);
+  ts.root = makeElement(1);
+  for (uint32_t i = 0; i < 10; ++i) {
+    ts.vec.push_back(makeElement(i));
+  }
+
+  ts.vecOfVec.resize(3, ts.vec);
+  ts.vecOfVec[1].clear();
+  ts.map["first"] = 1;
+  ts.map["second"] = 2;
+  return ts;
+}
+
+}
+
+TEST(JsonBufferSerializer, roundTrip) {
+  JsonTestStruct ts1 = makeStruct();
+  JsonTestStruct ts2;
+
+  std::string json = storeToJson(ts1);
+  ASSERT_TRUE(loadFromJson(ts2, json));
+  EXPECT_EQ(ts1, ts2);
+}
+
+TEST(JsonBufferSerializer, outputIsReadableByJsonValueSerializer) {
+  JsonTestStruct ts1 = makeStruct();
+  // JsonValue based serializers do not support nested arrays
+  ts1.vecOfVec.clear();
+  JsonTestStruct ts2;
+
+  JsonOutputBufferSerializer output;
+  serialize(ts1, output);
+
+  loadFromJsonValue(ts2, Common::JsonValue::fromString(output.getBuffer()));
+  EXPECT_EQ(ts1, ts2);
+}
+
+TEST(JsonBufferSerializer, readsJsonValueSerializerOutput) {
+  JsonTestStruct ts1 = makeStruct();
+  // JsonValue based serializers do not support nested arrays
+  ts1.vecOfVec.clear();
+  JsonTestStruct ts2;
+
+  JsonInputBufferSerializer input(storeToJsonValue(ts1).toString());
+  serialize(ts2, input);
+  EXPECT_EQ(ts1, ts2);
+}
+
+TEST(JsonBufferSerializer, membersAreFoundInAnyOrder) {
+  JsonInputBufferSerializer s(Common::StringView(" { \"c\" : [ 1 , 2 ] ,\n\"b\":\"text\", \"a\" : true, \"d\": {\"x\": -5} } "));
+
+  bool a = false;
+  std::string b;
+  std::vector<uint32_t> c;
+  int32_t x = 0;
+
+  ASSERT_TRUE(s(a, "a"));
+  ASSERT_TRUE(s(b, "b"));
+  ASSERT_TRUE(s(c, "c"));
+  ASSERT_TRUE(s.beginObject("d"));
+  ASSERT_TRUE(s(x, "x"));
+  s.endObject();
+
+  EXPECT_TRUE(a);
+  EXPECT_EQ("text", b);
+  EXPECT_EQ(std::vector<uint32_t>({1, 2}), c);
+  EXPECT_EQ(-5, x);
+
+  uint64_t missing = 7;
+  EXPECT_FALSE(s(missing, "missing"));
+  EXPECT_EQ(7, missing);
+}
+
+TEST(JsonBufferSerializer, rawValueKeepsText) {
+  JsonInputBufferSerializer input(Common::StringView("{\"id\": {\"a\": [1, \"x\"]}, \"n\": null}"));
+
+  Common::StringView id;
+  ASSERT_TRUE(input.rawValue(id, "id"));
+  EXPECT_EQ("{\"a\": [1, \"x\"]}", std::string(id));
+
+  JsonOutputBufferSerializer output;
+  output.rawValue(id, "id");
+  EXPECT_EQ("{\"id\":{\"a\": [1, \"x\"]}}", output.getBuffer());
+}
+
+TEST(JsonBufferSerializer, typeMismatchThrows) {
+  JsonInputBufferSerializer s(Common::StringView("{\"s\": \"text\", \"r\": 1.5, \"n\": 18446744073709551616}"));
+
+  uint32_t value;
+  EXPECT_ANY_THROW(s(value, "s"));
+  EXPECT_ANY_THROW(s(value, "r"));
+
+  uint64_t big;
+  EXPECT_ANY_THROW(s(big, "n"));
+
+  double real = 0;
+  ASSERT_TRUE(s(real, "r"));
+  EXPECT_DOUBLE_EQ(1.5, real);
+}
+
+TEST(JsonBufferSerializer, badDocumentsThrow) {
+  std::vector<std::string> badPatterns{
+    "",
+    "100",
+    "[10,20,30]",
+    "{",
+    "{\"prop: 100 }",
+    "{\"prop\" 100 }",
+    "{ prop: 100 }",
+    "{\"prop\": 01}",
+    "{\"prop\": 1..2}",
+    "{\"prop\": [100,}",
+    "{\"prop\": tru}",
+  };
+
+  for (const auto& p : badPatterns) {
+    EXPECT_ANY_THROW(JsonInputBufferSerializer s{Common::StringView(p)}) << p;
+  }
+}
+
+TEST(JsonRpcResponse, parsedFromTemporaryString) {
+  JsonRpc::JsonRpcResponse response;
+  response.parse(std::string("{\"jsonrpc\": \"2.0\", \"result\": {\"name\": \"abc\", \"nonce\": 7, \"delta\": -3, \"flag\": true, "
+    "\"blob\": \"000102030405060708090a0b0c0d0e0f\", \"u32array\": [4, 5]}}"));
+
+  // allocate over the memory the temporary used to occupy
+  std::vector<std::string> noise(16, std::string(256, 'x'));
+
+  JsonTestElement result;
+  ASSERT_TRUE(response.getResult(result));
+  EXPECT_EQ("abc", result.name);
+  EXPECT_EQ(7, result.nonce);
+  EXPECT_EQ(-3, result.delta);
+  EXPECT_TRUE(result.flag);
+  EXPECT_EQ(15, result.blob[15]);
+  EXPECT_EQ((std::vector<uint32_t>{4, 5}), result.u32array);
+}
+
+TEST(JsonRpcRequest, collectionAndStringParamsAreReadWithoutJsonValue) {
+  JsonRpc::JsonRpcRequest arrayRequest;
+  arrayRequest.parseRequest(std::string("{\"jsonrpc\": \"2.0\", \"method\": \"m\", \"params\": [\"a\", \"bc\"]}"));
+
+  std::vector<std::string> strings;
+  ASSERT_TRUE(arrayRequest.loadParams(strings));
+  EXPECT_EQ((std::vector<std::string>{"a", "bc"}), strings);
+
+  std::list<std::string> stringList;
+  ASSERT_TRUE(arrayRequest.loadParams(stringList));
+  EXPECT_EQ((std::list<std::string>{"a", "bc"}), stringList);
+
+  JsonRpc::JsonRpcRequest stringRequest;
+  stringRequest.parseRequest(std::string("{\"method\": \"m\", \"params\": \"text\"}"));
+
+  std::string text;
+  ASSERT_TRUE(stringRequest.loadParams(text));
+  EXPECT_EQ("text", text);
+  EXPECT_EQ("m", stringRequest.getMethod());
+}
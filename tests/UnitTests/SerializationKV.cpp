@@ -19,10 +19,12 @@
 
 #include <boost/lexical_cast.hpp>
 
+#include "Serialization/KVBinaryCommon.h"
 #include "Serialization/KVBinaryInputStreamSerializer.h"
 #include "Serialization/KVBinaryOutputStreamSerializer.h"
 #include "Serialization/SerializationOverloads.h"
 #include "Serialization/SerializationTools.h"
+#include "Rpc/CoreRpcServerCommandsDefinitions.h"
 
 #include <array>
 
@@ -152,3 +154,319 @@ TEST(KVSerialize, DISABLED_CollectionOfCollections) {
   ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(ts2, buf));
   EXPECT_EQ(ts1, ts2);
 }
+
+namespace {
+
+struct SmallSection {
+  uint32_t id;
+  std::string text;
+  uint8_t flag;
+
+  void serialize(ISerializer& s) {
+    s(id, "id");
+    s(text, "text");
+    s.beginObject("inner");
+    s(flag, "flag");
+    s.endObject();
+  }
+};
+
+struct WideSection {
+  std::vector<uint16_t> values;
+
+  void serialize(ISerializer& s) {
+    for (size_t i = 0; i < values.size(); ++i) {
+      s(values[i], "v" + std::to_string(i));
+    }
+  }
+};
+
+struct NestedWideSection {
+  WideSection wide;
+  uint32_t tail;
+
+  void serialize(ISerializer& s) {
+    s.beginObject("wide");
+    wide.serialize(s);
+    s.endObject();
+    s(tail, "tail");
+  }
+};
+
+WideSection makeWideSection(size_t count) {
+  WideSection ws;
+  for (size_t i = 0; i < count; ++i) {
+    ws.values.push_back(static_cast<uint16_t>(i * 7));
+  }
+
+  return ws;
+}
+
+// Encoders below follow the layout produced by the original stream based writer.
+void appendLegacyValue(std::string& out, uint64_t value, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    out.push_back(static_cast<char>(value >> (8 * i)));
+  }
+}
+
+void appendLegacyArraySize(std::string& out, size_t size) {
+  if (size <= 63) {
+    appendLegacyValue(out, (size << 2) | PORTABLE_RAW_SIZE_MARK_BYTE, 1);
+  } else if (size <= 16383) {
+    appendLegacyValue(out, (size << 2) | PORTABLE_RAW_SIZE_MARK_WORD, 2);
+  } else if (size <= 1073741823) {
+    appendLegacyValue(out, (size << 2) | PORTABLE_RAW_SIZE_MARK_DWORD, 4);
+  } else {
+    appendLegacyValue(out, (size << 2) | PORTABLE_RAW_SIZE_MARK_INT64, 8);
+  }
+}
+
+void appendLegacyName(std::string& out, const std::string& name, uint8_t type) {
+  out.push_back(static_cast<char>(name.size()));
+  out += name;
+  out.push_back(static_cast<char>(type));
+}
+
+void appendLegacyHeader(std::string& out) {
+  appendLegacyValue(out, PORTABLE_STORAGE_SIGNATUREA, 4);
+  appendLegacyValue(out, PORTABLE_STORAGE_SIGNATUREB, 4);
+  appendLegacyValue(out, PORTABLE_STORAGE_FORMAT_VER, 1);
+}
+
+void appendLegacyWideMembers(std::string& out, const WideSection& ws) {
+  appendLegacyArraySize(out, ws.values.size());
+  for (size_t i = 0; i < ws.values.size(); ++i) {
+    appendLegacyName(out, "v" + std::to_string(i), BIN_KV_SERIALIZE_TYPE_UINT16);
+    appendLegacyValue(out, ws.values[i], sizeof(uint16_t));
+  }
+}
+
+std::string legacyWideSection(const WideSection& ws) {
+  std::string out;
+  appendLegacyHeader(out);
+  appendLegacyWideMembers(out, ws);
+  return out;
+}
+
+std::string legacyNestedWideSection(const NestedWideSection& nws) {
+  std::string out;
+  appendLegacyHeader(out);
+  appendLegacyArraySize(out, 2);
+  appendLegacyName(out, "wide", BIN_KV_SERIALIZE_TYPE_OBJECT);
+  appendLegacyWideMembers(out, nws.wide);
+  appendLegacyName(out, "tail", BIN_KV_SERIALIZE_TYPE_UINT32);
+  appendLegacyValue(out, nws.tail, sizeof(uint32_t));
+  return out;
+}
+
+std::string dumpToString(KVBinaryOutputStreamSerializer& s) {
+  std::string result;
+  Common::StringOutputStream stream(result);
+  s.dump(stream);
+  return result;
+}
+
+struct ReversedTestElement {
+  TestElement element;
+
+  void serialize(ISerializer& s) {
+    serializeAsBinary(element.u32array, "u32array", s);
+    s.binary(element.blob.data(), element.blob.size(), "blob");
+    s(element.nonce, "nonce");
+    s(element.name, "name");
+  }
+};
+
+}
+
+TEST(KVSerialize, ExactLayout) {
+  SmallSection section{ 0x01020304, "ab", 7 };
+
+  const uint8_t expected[] = {
+    0x01, 0x11, 0x01, 0x01, 0x01, 0x01, 0x02, 0x01, 0x01, // header
+    0x0c, // 3 members
+    0x02, 'i', 'd', 0x06, 0x04, 0x03, 0x02, 0x01,
+    0x04, 't', 'e', 'x', 't', 0x0a, 0x08, 'a', 'b',
+    0x05, 'i', 'n', 'n', 'e', 'r', 0x0c, 0x04, // 1 member
+    0x04, 'f', 'l', 'a', 'g', 0x08, 0x07
+  };
+
+  std::string buf = CryptoNote::storeToBinaryKeyValue(section);
+  ASSERT_EQ(std::string(reinterpret_cast<const char*>(expected), sizeof(expected)), buf);
+}
+
+TEST(KVSerialize, SectionWithManyMembers) {
+  WideSection ws1;
+  for (uint16_t i = 0; i < 100; ++i) {
+    ws1.values.push_back(i * 3);
+  }
+
+  WideSection ws2;
+  ws2.values.resize(ws1.values.size());
+
+  std::string buf = CryptoNote::storeToBinaryKeyValue(std::make_pair(ws1, ws1.values.size()));
+  std::pair<WideSection, size_t> loaded(ws2, 0);
+  ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(loaded, buf));
+  EXPECT_EQ(ws1.values, loaded.first.values);
+  EXPECT_EQ(ws1.values.size(), loaded.second);
+}
+
+TEST(KVSerialize, WordSizedSectionMatchesLegacyLayout) {
+  WideSection ws = makeWideSection(100);
+  ASSERT_EQ(legacyWideSection(ws), CryptoNote::storeToBinaryKeyValue(ws));
+
+  NestedWideSection nws{ makeWideSection(100), 0xdeadbeef };
+  ASSERT_EQ(legacyNestedWideSection(nws), CryptoNote::storeToBinaryKeyValue(nws));
+}
+
+TEST(KVSerialize, DwordSizedSectionMatchesLegacyLayout) {
+  WideSection ws = makeWideSection(16384 + 100);
+  ASSERT_EQ(legacyWideSection(ws), CryptoNote::storeToBinaryKeyValue(ws));
+
+  NestedWideSection nws{ makeWideSection(16384 + 100), 0xdeadbeef };
+  std::string buf = CryptoNote::storeToBinaryKeyValue(nws);
+  ASSERT_EQ(legacyNestedWideSection(nws), buf);
+
+  NestedWideSection loaded{ makeWideSection(nws.wide.values.size()), 0 };
+  ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(loaded, buf));
+  EXPECT_EQ(nws.wide.values, loaded.wide.values);
+  EXPECT_EQ(nws.tail, loaded.tail);
+}
+
+TEST(KVSerialize, WrittenSectionsMatchNestedObjects) {
+  TestStruct ts;
+  ts.u8 = 1;
+  ts.u32 = 2;
+  ts.u64 = 3;
+  ts.root.name = "root";
+  ts.root.nonce = 4;
+  ts.root.blob.fill(0x11);
+
+  TestElement element;
+  element.name = "element";
+  element.nonce = 5;
+  element.blob.fill(0x22);
+  element.u32array.assign(3, 6);
+  ts.vec1.assign(3, element);
+
+  KVBinaryOutputStreamSerializer s;
+  s.writeSection(CryptoNote::storeToBinaryKeyValueSection(ts.root), "root");
+
+  size_t count = ts.vec1.size();
+  s.beginArray(count, "vec1");
+  for (const auto& item : ts.vec1) {
+    s.writeSection(CryptoNote::storeToBinaryKeyValueSection(item), "");
+  }
+  s.endArray();
+
+  size_t emptyCount = 0;
+  s.beginArray(emptyCount, "vec2");
+  s.endArray();
+  s.beginArray(emptyCount, "vecOfVec");
+  s.endArray();
+
+  s(ts.u8, "u8");
+  s(ts.u32, "u32");
+  s(ts.u64, "u64");
+
+  EXPECT_EQ(CryptoNote::storeToBinaryKeyValue(ts), dumpToString(s));
+}
+
+TEST(KVSerialize, WrittenWideSectionMatchesLegacyLayout) {
+  NestedWideSection nws{ makeWideSection(100), 0xdeadbeef };
+
+  KVBinaryOutputStreamSerializer s;
+  s.writeSection(CryptoNote::storeToBinaryKeyValueSection(nws.wide), "wide");
+  s(nws.tail, "tail");
+
+  EXPECT_EQ(legacyNestedWideSection(nws), dumpToString(s));
+}
+
+TEST(KVSerialize, MembersReadInAnyOrder) {
+  TestElement testData;
+  testData.name = "hello";
+  testData.nonce = 12345;
+  testData.blob.fill(0xab);
+  testData.u32array.assign(10, 42);
+
+  ReversedTestElement loaded;
+  std::string buf = CryptoNote::storeToBinaryKeyValue(testData);
+  ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(loaded, buf));
+  EXPECT_EQ(testData, loaded.element);
+}
+
+TEST(KVSerialize, QueryBlocksScanResponseRoundTrip) {
+  COMMAND_RPC_QUERY_BLOCKS_SCAN::response res;
+  res.status = CORE_RPC_STATUS_OK;
+  res.startHeight = 10;
+  res.currentHeight = 12;
+  res.fullOffset = 11;
+
+  BlockScanInfo hashOnly;
+  hashOnly.blockId.data[0] = 1;
+  hashOnly.timestamp = 0;
+  res.items.push_back(hashOnly);
+
+  BlockScanInfo full;
+  full.blockId.data[0] = 2;
+  full.timestamp = 1500000000;
+  for (uint8_t i = 0; i < 2; ++i) {
+    TransactionScanInfo tx;
+    tx.txHash.data[0] = 3 + i;
+    tx.txPublicKey.data[0] = 5 + i;
+    tx.unlockTime = 20 + i;
+    tx.outputs.push_back(OutputScanInfo{ 100u + i, tx.txPublicKey, 7u + i });
+    tx.outputs.push_back(OutputScanInfo{ 200u + i, tx.txPublicKey, 9u + i });
+    full.transactions.push_back(tx);
+  }
+
+  Crypto::KeyImage keyImage;
+  keyImage.data[0] = 11;
+  full.transactions.back().keyImages.assign(3, keyImage);
+  res.items.push_back(full);
+
+  std::string buf = CryptoNote::storeToBinaryKeyValue(res);
+  COMMAND_RPC_QUERY_BLOCKS_SCAN::response loaded;
+  ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(loaded, buf));
+
+  EXPECT_EQ(res.status, loaded.status);
+  EXPECT_EQ(res.startHeight, loaded.startHeight);
+  EXPECT_EQ(res.currentHeight, loaded.currentHeight);
+  EXPECT_EQ(res.fullOffset, loaded.fullOffset);
+  ASSERT_EQ(2, loaded.items.size());
+  EXPECT_EQ(hashOnly.blockId, loaded.items[0].blockId);
+  EXPECT_TRUE(loaded.items[0].transactions.empty());
+
+  const auto& loadedFull = loaded.items[1];
+  EXPECT_EQ(full.blockId, loadedFull.blockId);
+  EXPECT_EQ(full.timestamp, loadedFull.timestamp);
+  ASSERT_EQ(full.transactions.size(), loadedFull.transactions.size());
+  for (size_t i = 0; i < full.transactions.size(); ++i) {
+    const auto& tx = full.transactions[i];
+    const auto& loadedTx = loadedFull.transactions[i];
+    EXPECT_EQ(tx.txHash, loadedTx.txHash);
+    EXPECT_EQ(tx.txPublicKey, loadedTx.txPublicKey);
+    EXPECT_EQ(tx.unlockTime, loadedTx.unlockTime);
+    EXPECT_EQ(tx.keyImages, loadedTx.keyImages);
+    ASSERT_EQ(tx.outputs.size(), loadedTx.outputs.size());
+    for (size_t j = 0; j < tx.outputs.size(); ++j) {
+      EXPECT_EQ(tx.outputs[j].amount, loadedTx.outputs[j].amount);
+      EXPECT_EQ(tx.outputs[j].key, loadedTx.outputs[j].key);
+      EXPECT_EQ(tx.outputs[j].globalIndex, loadedTx.outputs[j].globalIndex);
+    }
+  }
+
+  EXPECT_EQ(buf, CryptoNote::storeToBinaryKeyValue(loaded));
+}
+
+TEST(KVSerialize, TruncatedData) {
+  TestElement testData;
+  testData.name = "hello";
+  testData.u32array.resize(16);
+
+  std::string buf = CryptoNote::storeToBinaryKeyValue(testData);
+  for (size_t size = 0; size < buf.size(); ++size) {
+    TestElement loaded;
+    EXPECT_FALSE(CryptoNote::loadFromBinaryKeyValue(loaded, buf.substr(0, size)));
+  }
+}
@@ -0,0 +1,125 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "Rpc/BlockFragmentCache.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+Crypto::Hash makeHash(uint8_t value) {
+  Crypto::Hash hash;
+  std::fill(std::begin(hash.data), std::end(hash.data), value);
+  return hash;
+}
+
+const BlockFragmentCache::Format RAW = BlockFragmentCache::Format::RawBlock;
+const BlockFragmentCache::Format DETAILS = BlockFragmentCache::Format::BlockDetails;
+
+}
+
+TEST(BlockFragmentCache, countsHitsAndMisses) {
+  BlockFragmentCache cache(100);
+
+  ASSERT_TRUE(cache.find(makeHash(1), RAW) == nullptr);
+  cache.insert(makeHash(1), RAW, "abc");
+
+  auto fragment = cache.find(makeHash(1), RAW);
+  ASSERT_TRUE(fragment != nullptr);
+  EXPECT_EQ("abc", *fragment);
+  EXPECT_EQ(1, cache.getHitCount());
+  EXPECT_EQ(1, cache.getMissCount());
+}
+
+TEST(BlockFragmentCache, keepsFormatsOfOneBlockApart) {
+  BlockFragmentCache cache(100);
+
+  cache.insert(makeHash(1), RAW, "raw");
+  ASSERT_TRUE(cache.find(makeHash(1), DETAILS) == nullptr);
+
+  cache.insert(makeHash(1), DETAILS, "details");
+  EXPECT_EQ("raw", *cache.find(makeHash(1), RAW));
+  EXPECT_EQ("details", *cache.find(makeHash(1), DETAILS));
+  EXPECT_EQ(2, cache.getFragmentCount());
+  EXPECT_EQ(10, cache.getSize());
+}
+
+TEST(BlockFragmentCache, evictsLeastRecentlyUsedWhenFull) {
+  BlockFragmentCache cache(9);
+
+  cache.insert(makeHash(1), RAW, "111");
+  cache.insert(makeHash(2), RAW, "222");
+  cache.insert(makeHash(3), RAW, "333");
+  ASSERT_TRUE(cache.find(makeHash(1), RAW) != nullptr);
+
+  cache.insert(makeHash(4), RAW, "444");
+
+  EXPECT_TRUE(cache.find(makeHash(2), RAW) == nullptr);
+  EXPECT_TRUE(cache.find(makeHash(1), RAW) != nullptr);
+  EXPECT_TRUE(cache.find(makeHash(3), RAW) != nullptr);
+  EXPECT_TRUE(cache.find(makeHash(4), RAW) != nullptr);
+  EXPECT_EQ(9, cache.getSize());
+}
+
+TEST(BlockFragmentCache, evictedFragmentStaysValid) {
+  BlockFragmentCache cache(3);
+
+  auto fragment = cache.insert(makeHash(1), RAW, "111");
+  cache.insert(makeHash(2), RAW, "222");
+
+  ASSERT_TRUE(cache.find(makeHash(1), RAW) == nullptr);
+  EXPECT_EQ("111", *fragment);
+}
+
+TEST(BlockFragmentCache, doesNotCacheFragmentLargerThanLimit) {
+  BlockFragmentCache cache(3);
+  cache.insert(makeHash(1), RAW, "111");
+
+  auto fragment = cache.insert(makeHash(2), RAW, "2222");
+
+  EXPECT_EQ("2222", *fragment);
+  EXPECT_TRUE(cache.find(makeHash(2), RAW) == nullptr);
+  EXPECT_TRUE(cache.find(makeHash(1), RAW) != nullptr);
+  EXPECT_EQ(3, cache.getSize());
+}
+
+TEST(BlockFragmentCache, insertReplacesExistingFragment) {
+  BlockFragmentCache cache(100);
+
+  cache.insert(makeHash(1), RAW, "old");
+  cache.insert(makeHash(1), RAW, "newer");
+
+  EXPECT_EQ("newer", *cache.find(makeHash(1), RAW));
+  EXPECT_EQ(1, cache.getFragmentCount());
+  EXPECT_EQ(5, cache.getSize());
+}
+
+TEST(BlockFragmentCache, clearDropsFragmentsAndKeepsCounters) {
+  BlockFragmentCache cache(100);
+  cache.insert(makeHash(1), RAW, "111");
+  cache.find(makeHash(1), RAW);
+
+  cache.clear();
+
+  EXPECT_TRUE(cache.find(makeHash(1), RAW) == nullptr);
+  EXPECT_EQ(0, cache.getFragmentCount());
+  EXPECT_EQ(0, cache.getSize());
+  EXPECT_EQ(1, cache.getHitCount());
+  EXPECT_EQ(1, cache.getMissCount());
+}
@@ -0,0 +1,148 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "CryptoNoteCore/BufferedDataBase.h"
+#include "DataBaseMock.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+class TestWriteBatch : public IWriteBatch {
+public:
+  std::vector<std::pair<std::string, std::string>> extractRawDataToInsert() override {
+    return std::move(insert);
+  }
+
+  std::vector<std::string> extractRawKeysToRemove() override {
+    return std::move(remove);
+  }
+
+  std::vector<std::pair<std::string, std::string>> insert;
+  std::vector<std::string> remove;
+};
+
+class TestReadBatch : public IReadBatch {
+public:
+  explicit TestReadBatch(std::vector<std::string> keys) : keys(std::move(keys)) {
+  }
+
+  std::vector<std::string> getRawKeys() const override {
+    return keys;
+  }
+
+  void submitRawResult(const std::vector<std::string>& resultValues, const std::vector<bool>& resultStates) override {
+    values = resultValues;
+    states = resultStates;
+  }
+
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  std::vector<bool> states;
+};
+
+class BufferedDataBaseTests : public ::testing::Test {
+public:
+  BufferedDataBaseTests() : database(mock) {
+  }
+
+  void put(const std::string& key, const std::string& value) {
+    TestWriteBatch batch;
+    batch.insert.emplace_back(key, value);
+    ASSERT_FALSE(database.write(batch));
+  }
+
+  void remove(const std::string& key) {
+    TestWriteBatch batch;
+    batch.remove.push_back(key);
+    ASSERT_FALSE(database.write(batch));
+  }
+
+  DataBaseMock mock;
+  BufferedDataBase database;
+};
+
+TEST_F(BufferedDataBaseTests, writesGoThroughWhenNotBuffering) {
+  put("a", "1");
+  ASSERT_EQ(1, mock.baseState.count("a"));
+  ASSERT_EQ(0, database.getBufferedSize());
+}
+
+TEST_F(BufferedDataBaseTests, bufferedWritesAreNotWrittenUntilFlush) {
+  database.beginBuffering();
+  put("a", "1");
+
+  ASSERT_EQ(0, mock.baseState.count("a"));
+  ASSERT_NE(0, database.getBufferedSize());
+
+  ASSERT_FALSE(database.flushBuffer());
+  ASSERT_EQ("1", mock.baseState["a"]);
+  ASSERT_EQ(0, database.getBufferedSize());
+  ASSERT_TRUE(database.isBuffering());
+}
+
+TEST_F(BufferedDataBaseTests, readSeesBufferedWritesAndUnderlyingData) {
+  mock.baseState["a"] = "old";
+  mock.baseState["b"] = "2";
+  mock.baseState["c"] = "3";
+
+  database.beginBuffering();
+  put("a", "1");
+  remove("c");
+  put("d", "4");
+
+  TestReadBatch batch({"a", "b", "c", "d", "e"});
+  ASSERT_FALSE(database.read(batch));
+
+  ASSERT_EQ((std::vector<bool>{true, true, false, true, false}), batch.states);
+  ASSERT_EQ("1", batch.values[0]);
+  ASSERT_EQ("2", batch.values[1]);
+  ASSERT_EQ("4", batch.values[3]);
+}
+
+TEST_F(BufferedDataBaseTests, removalInSameBatchWinsOverInsertion) {
+  database.beginBuffering();
+
+  TestWriteBatch batch;
+  batch.insert.emplace_back("a", "1");
+  batch.remove.push_back("a");
+  ASSERT_FALSE(database.write(batch));
+
+  TestReadBatch readBatch({"a"});
+  ASSERT_FALSE(database.read(readBatch));
+  ASSERT_FALSE(readBatch.states[0]);
+}
+
+TEST_F(BufferedDataBaseTests, endBufferingWritesBufferAndStopsBuffering) {
+  mock.baseState["b"] = "2";
+
+  database.beginBuffering();
+  put("a", "1");
+  remove("b");
+  ASSERT_FALSE(database.endBuffering());
+
+  ASSERT_FALSE(database.isBuffering());
+  ASSERT_EQ("1", mock.baseState["a"]);
+  ASSERT_EQ(0, mock.baseState.count("b"));
+
+  put("c", "3");
+  ASSERT_EQ("3", mock.baseState["c"]);
+}
+
+}
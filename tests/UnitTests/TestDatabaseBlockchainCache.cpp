@@ -25,10 +25,13 @@
 #include "CryptoNoteCore/TransactionValidatiorState.h"
 #include "DataBaseMock.h"
 #include <CryptoNoteCore/DBUtils.h>
+#include "CryptoNoteCore/MainChainStorage.h"
 #include "CryptoNoteCore/MemoryBlockchainCacheFactory.h"
 #include "Logging/FileLogger.h"
 #include "TestBlockchainGenerator.h"
 
+#include <boost/filesystem/operations.hpp>
+
 using namespace CryptoNote;
 using namespace Crypto;
 
@@ -186,3 +189,90 @@ TEST_F(DatabaseBlockchainCacheTests, RawBlocksWithTxsSerialization) {
   ASSERT_EQ(deserializedRawBlock.block, rawBlock.block);
   ASSERT_EQ(deserializedRawBlock.transactions, rawBlock.transactions);
 }
+
+namespace {
+
+class DatabaseBlockchainCacheStorageTests : public ::testing::Test {
+public:
+  DatabaseBlockchainCacheStorageTests()
+      : currency(CurrencyBuilder(logger).currency()), blockchainCacheFactory("", logger), generator(currency) {
+  }
+
+  void SetUp() override {
+    dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("test_data_dir_%%%%%%%%%%%%");
+    boost::filesystem::create_directory(dir);
+
+    storage.reset(new MainChainStorage((dir / "blocks.bin").string(), (dir / "blockindexes.bin.offsets").string()));
+    storage->pushBlock({ toBinaryArray(currency.genesisBlock()), {} });
+    blockchain.reset(new DatabaseBlockchainCache(currency, database, blockchainCacheFactory, logger, storage.get()));
+
+    generator.generateEmptyBlocks(5);
+    auto blocks = generator.getBlockchainCopy();
+    for (auto it = std::next(blocks.begin()); it != blocks.end(); ++it) {
+      const BlockTemplate& block = *it;
+      RawBlock rawBlock{ toBinaryArray(block), {} };
+      storage->pushBlock(rawBlock);
+
+      TransactionValidatorState state;
+      CachedBlock cached{block};
+      generatedBlockHashes.push_back(cached.getBlockHash());
+      blockchain->pushBlock(cached, {}, state, getObjectBinarySize(block.baseTransaction), 0, 1, std::move(rawBlock));
+    }
+  }
+
+  void TearDown() override {
+    blockchain.reset();
+    storage.reset();
+
+    boost::system::error_code ignoredErrorCode;
+    boost::filesystem::remove_all(dir, ignoredErrorCode);
+  }
+
+  Currency currency;
+  DataBaseMock database;
+  Logging::FileLogger logger;
+  MemoryBlockchainCacheFactory blockchainCacheFactory;
+  TestBlockchainGenerator generator;
+  boost::filesystem::path dir;
+  std::unique_ptr<MainChainStorage> storage;
+  std::unique_ptr<DatabaseBlockchainCache> blockchain;
+  std::vector<Hash> generatedBlockHashes;
+};
+
+}
+
+TEST_F(DatabaseBlockchainCacheStorageTests, RawBlocksAreNotCopiedToDatabase) {
+  ASSERT_TRUE(database.blocks().empty());
+}
+
+TEST_F(DatabaseBlockchainCacheStorageTests, RawBlocksAreReadFromStorage) {
+  for (uint32_t i = 0; i < storage->getBlockCount(); ++i) {
+    ASSERT_EQ(storage->getBlockByIndex(i).block, blockchain->getBlockByIndex(i).block);
+  }
+}
+
+TEST_F(DatabaseBlockchainCacheStorageTests, SplitMovesBlocksFromStorage) {
+  uint32_t splitIndex = 3;
+  auto child = blockchain->split(splitIndex);
+
+  ASSERT_EQ(splitIndex - 1, blockchain->getTopBlockIndex());
+  ASSERT_EQ(generatedBlockHashes.back(), child->getTopBlockHash());
+  ASSERT_EQ(storage->getBlockByIndex(splitIndex).block, child->getBlockByIndex(splitIndex).block);
+}
+
+TEST_F(DatabaseBlockchainCacheStorageTests, RawBlockStorageIsConsistent) {
+  ASSERT_TRUE(DatabaseBlockchainCache::checkRawBlockStorage(database, *storage, logger));
+}
+
+TEST_F(DatabaseBlockchainCacheStorageTests, RawBlockStorageMissingTopBlockIsDetected) {
+  storage->popBlock();
+
+  ASSERT_FALSE(DatabaseBlockchainCache::checkRawBlockStorage(database, *storage, logger));
+}
+
+TEST_F(DatabaseBlockchainCacheStorageTests, RawBlockStorageOverwrittenTopBlockIsDetected) {
+  storage->popBlock();
+  storage->pushBlock(storage->getBlockByIndex(1));
+
+  ASSERT_FALSE(DatabaseBlockchainCache::checkRawBlockStorage(database, *storage, logger));
+}
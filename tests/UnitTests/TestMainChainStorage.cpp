@@ -0,0 +1,296 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <fstream>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/MainChainStorage.h"
+#include "CryptoNoteCore/SwappedVector.h"
+#include "Logging/ConsoleLogger.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const uint64_t TEST_SEGMENT_SIZE = 4096;
+const uint32_t TEST_COMMIT_INTERVAL = 1000;
+
+class MainChainStorageTest : public ::testing::Test {
+public:
+  void SetUp() override {
+    m_dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("test_data_dir_%%%%%%%%%%%%");
+    boost::system::error_code ignoredErrorCode;
+    boost::filesystem::create_directory(m_dir, ignoredErrorCode);
+  }
+
+  void TearDown() override {
+    boost::system::error_code ignoredErrorCode;
+    boost::filesystem::remove_all(m_dir, ignoredErrorCode);
+  }
+
+  std::vector<RawBlock> generateRandomBlocks(size_t blocksNumber, size_t txsPerBlock) {
+    const size_t BLOCK_SIZE = 100;
+    const size_t TX_SIZE = 50;
+    std::vector<RawBlock> blocks;
+    for (size_t i = 0; i < blocksNumber; ++i) {
+      RawBlock block;
+      for (size_t j = 0; j < BLOCK_SIZE; ++j) {
+        block.block.push_back(rand());
+      }
+
+      for (size_t j = 0; j < txsPerBlock; ++j) {
+        BinaryArray rawTx;
+        for (size_t k = 0; k < TX_SIZE; ++k) {
+          rawTx.push_back(rand());
+        }
+
+        block.transactions.push_back(rawTx);
+      }
+
+      blocks.push_back(block);
+    }
+
+    return blocks;
+  }
+
+  std::unique_ptr<MainChainStorage> openStorage(uint32_t commitInterval = TEST_COMMIT_INTERVAL) {
+    return std::unique_ptr<MainChainStorage>(new MainChainStorage(blocksFilename(), indexesFilename(), TEST_SEGMENT_SIZE, commitInterval));
+  }
+
+  void checkBlocks(const MainChainStorage& storage, const std::vector<RawBlock>& blocks) {
+    ASSERT_EQ(blocks.size(), storage.getBlockCount());
+    for (uint32_t i = 0; i < blocks.size(); ++i) {
+      RawBlock block = storage.getBlockByIndex(i);
+      ASSERT_EQ(blocks[i].block, block.block);
+      ASSERT_EQ(blocks[i].transactions, block.transactions);
+    }
+  }
+
+  uint64_t readIndexEntry(size_t index) {
+    // index prefix (version, segment size, committed count), vector capacity and size precede the offsets
+    std::ifstream file(indexesFilename(), std::ios::binary);
+    file.seekg(5 * sizeof(uint64_t) + index * sizeof(uint64_t));
+    uint64_t value;
+    file.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return value;
+  }
+
+  void writeFileValue(const std::string& filename, uint64_t offset, const void* data, size_t size) {
+    std::fstream file(filename, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(offset);
+    file.write(reinterpret_cast<const char*>(data), size);
+  }
+
+  std::string blocksFilename() const {
+    return (m_dir / "blocks.bin").string();
+  }
+
+  std::string indexesFilename() const {
+    return (m_dir / "blockindexes.bin.offsets").string();
+  }
+
+protected:
+  boost::filesystem::path m_dir;
+};
+
+TEST_F(MainChainStorageTest, pushedBlocksCanBeRead) {
+  auto blocks = generateRandomBlocks(10, 3);
+  auto storage = openStorage();
+  for (const auto& block : blocks) {
+    storage->pushBlock(block);
+  }
+
+  checkBlocks(*storage, blocks);
+}
+
+TEST_F(MainChainStorageTest, rawBlockViewMatchesSerializedBlock) {
+  auto blocks = generateRandomBlocks(3, 2);
+  auto storage = openStorage();
+  for (const auto& block : blocks) {
+    storage->pushBlock(block);
+  }
+
+  for (uint32_t i = 0; i < blocks.size(); ++i) {
+    BinaryArray serialized = toBinaryArray(blocks[i]);
+    Common::ArrayView<uint8_t> view = storage->getRawBlockView(i);
+    ASSERT_EQ(serialized.size(), view.getSize());
+    ASSERT_EQ(0, std::memcmp(serialized.data(), view.getData(), serialized.size()));
+  }
+}
+
+TEST_F(MainChainStorageTest, getBlockByIndexThrowsOutOfRange) {
+  auto storage = openStorage();
+  storage->pushBlock(generateRandomBlocks(1, 1)[0]);
+
+  ASSERT_THROW(storage->getBlockByIndex(1), std::out_of_range);
+}
+
+TEST_F(MainChainStorageTest, blocksSpanSeveralSegments) {
+  auto blocks = generateRandomBlocks(40, 4);
+  {
+    auto storage = openStorage();
+    for (const auto& block : blocks) {
+      storage->pushBlock(block);
+    }
+
+    checkBlocks(*storage, blocks);
+  }
+
+  ASSERT_TRUE(boost::filesystem::exists(blocksFilename() + ".000000"));
+  ASSERT_TRUE(boost::filesystem::exists(blocksFilename() + ".000001"));
+
+  auto storage = openStorage();
+  checkBlocks(*storage, blocks);
+}
+
+TEST_F(MainChainStorageTest, blockBiggerThanSegmentIsRejected) {
+  auto storage = openStorage();
+  RawBlock block;
+  block.block.resize(TEST_SEGMENT_SIZE);
+
+  ASSERT_THROW(storage->pushBlock(block), std::runtime_error);
+  ASSERT_EQ(0, storage->getBlockCount());
+}
+
+TEST_F(MainChainStorageTest, reopenedStorageKeepsBlocks) {
+  auto blocks = generateRandomBlocks(20, 2);
+  {
+    auto storage = openStorage(7);
+    for (const auto& block : blocks) {
+      storage->pushBlock(block);
+    }
+  }
+
+  auto storage = openStorage(7);
+  checkBlocks(*storage, blocks);
+}
+
+TEST_F(MainChainStorageTest, poppedBlocksAreOverwritten) {
+  auto blocks = generateRandomBlocks(30, 2);
+  auto replacement = generateRandomBlocks(15, 5);
+  {
+    auto storage = openStorage();
+    for (const auto& block : blocks) {
+      storage->pushBlock(block);
+    }
+
+    storage->commit();
+
+    for (size_t i = 0; i < 10; ++i) {
+      storage->popBlock();
+    }
+
+    for (const auto& block : replacement) {
+      storage->pushBlock(block);
+    }
+  }
+
+  blocks.resize(20);
+  blocks.insert(blocks.end(), replacement.begin(), replacement.end());
+
+  auto storage = openStorage();
+  checkBlocks(*storage, blocks);
+}
+
+TEST_F(MainChainStorageTest, tornTailIsCutOnOpen) {
+  auto blocks = generateRandomBlocks(10, 2);
+  {
+    auto storage = openStorage();
+    for (const auto& block : blocks) {
+      storage->pushBlock(block);
+    }
+  }
+
+  // Pretend only 5 blocks were committed and the data of block 7 never reached the disk
+  uint64_t committedCount = 5;
+  writeFileValue(indexesFilename(), 2 * sizeof(uint64_t), &committedCount, sizeof(committedCount));
+  uint64_t recordOffset = readIndexEntry(7);
+  uint8_t garbage = 0;
+  writeFileValue(blocksFilename() + ".000000", recordOffset % TEST_SEGMENT_SIZE + 20, &garbage, sizeof(garbage));
+
+  blocks.resize(7);
+  {
+    auto storage = openStorage();
+    checkBlocks(*storage, blocks);
+  }
+
+  auto storage = openStorage();
+  checkBlocks(*storage, blocks);
+}
+
+TEST_F(MainChainStorageTest, clearRemovesBlocks) {
+  auto blocks = generateRandomBlocks(40, 4);
+  {
+    auto storage = openStorage();
+    for (const auto& block : blocks) {
+      storage->pushBlock(block);
+    }
+
+    storage->clear();
+    ASSERT_EQ(0, storage->getBlockCount());
+    ASSERT_FALSE(boost::filesystem::exists(blocksFilename() + ".000001"));
+
+    storage->pushBlock(blocks[0]);
+  }
+
+  blocks.resize(1);
+  auto storage = openStorage();
+  checkBlocks(*storage, blocks);
+}
+
+TEST_F(MainChainStorageTest, legacyStorageIsImported) {
+  Logging::ConsoleLogger logger;
+  Currency currency = CurrencyBuilder(logger).currency();
+  auto blocks = generateRandomBlocks(10, 2);
+  std::string legacyBlocksFilename = (m_dir / currency.blocksFileName()).string();
+  std::string legacyIndexesFilename = (m_dir / currency.blockIndexesFileName()).string();
+
+  {
+    SwappedVector<RawBlock> legacyStorage;
+    ASSERT_TRUE(legacyStorage.open(legacyBlocksFilename, legacyIndexesFilename, 10));
+    for (const auto& block : blocks) {
+      legacyStorage.push_back(block);
+    }
+
+    legacyStorage.close();
+  }
+
+  auto storage = createMainChainStorage(m_dir.string(), currency);
+
+  ASSERT_EQ(blocks.size(), storage->getBlockCount());
+  ASSERT_EQ(blocks.back().block, storage->getBlockByIndex(static_cast<uint32_t>(blocks.size() - 1)).block);
+  ASSERT_FALSE(boost::filesystem::exists(legacyBlocksFilename));
+  ASSERT_FALSE(boost::filesystem::exists(legacyIndexesFilename));
+}
+
+TEST_F(MainChainStorageTest, newStorageStartsWithGenesisBlock) {
+  Logging::ConsoleLogger logger;
+  Currency currency = CurrencyBuilder(logger).currency();
+
+  auto storage = createMainChainStorage(m_dir.string(), currency);
+
+  ASSERT_EQ(1, storage->getBlockCount());
+  ASSERT_EQ(toBinaryArray(currency.genesisBlock()), storage->getBlockByIndex(0).block);
+}
+
+}
@@ -435,3 +435,129 @@ TEST_F(TransfersApi, sameTrackingKey) {
   }
 
 }
+
+TEST_F(TransfersApi, catchUpSubscriptionScansBlocksBeforeMainConsumer) {
+  addPaymentAccounts(2);
+
+  m_subscriptions.push_back(&m_transfersSync.addSubscription(createSubscription(0)));
+
+  generateMoneyForAccount(1);
+  generator.generateEmptyBlocks(10);
+
+  startSync();
+  m_sync.stop();
+
+  auto& sub = m_transfersSync.addCatchUpSubscription(createSubscription(1));
+  ASSERT_TRUE(m_transfersSync.hasCatchUpSubscriptions());
+  ASSERT_FALSE(m_transfersSync.hasCaughtUpSubscriptions());
+  ASSERT_EQ(&sub, m_transfersSync.getSubscription(m_accounts[1].address));
+
+  std::vector<AccountPublicAddress> subscriptions;
+  m_transfersSync.getSubscriptions(subscriptions);
+  ASSERT_EQ(2, subscriptions.size());
+
+  startSync();
+  m_sync.stop();
+
+  ASSERT_TRUE(m_transfersSync.hasCaughtUpSubscriptions());
+  ASSERT_EQ(1, m_transfersSync.mergeCaughtUpSubscriptions());
+  ASSERT_FALSE(m_transfersSync.hasCatchUpSubscriptions());
+
+  ASSERT_EQ(&sub, m_transfersSync.getSubscription(m_accounts[1].address));
+  ASSERT_NE(0, sub.getContainer().balance(ITransfersContainer::IncludeAll));
+  ASSERT_EQ(0, m_subscriptions[0]->getContainer().transfersCount());
+}
+
+TEST_F(TransfersApi, catchUpSubscriptionSurvivesSaveAndLoad) {
+  addPaymentAccounts(2);
+
+  m_subscriptions.push_back(&m_transfersSync.addSubscription(createSubscription(0)));
+
+  generateMoneyForAccount(1);
+  generator.generateEmptyBlocks(10);
+
+  startSync();
+  m_sync.stop();
+
+  m_transfersSync.addCatchUpSubscription(createSubscription(1));
+  startSync();
+  m_sync.stop();
+
+  // the rescan has reached the main consumer, but the wallet is saved before the merge
+  ASSERT_TRUE(m_transfersSync.hasCaughtUpSubscriptions());
+  auto balance = m_transfersSync.getSubscription(m_accounts[1].address)->getContainer().balance(ITransfersContainer::IncludeAll);
+  ASSERT_NE(0, balance);
+
+  std::stringstream memstm;
+  m_transfersSync.save(memstm);
+
+  BlockchainSynchronizer bsync2(m_node, m_logger, m_currency.genesisBlockHash());
+  TransfersSyncronizer sync2(m_currency, m_logger, bsync2, m_node);
+  sync2.addSubscription(createSubscription(0));
+  sync2.addSubscription(createSubscription(1));
+
+  sync2.load(memstm);
+
+  ASSERT_TRUE(sync2.hasCatchUpSubscriptions());
+  // the catch up consumer keeps its height, so it is still level with the main one
+  ASSERT_TRUE(sync2.hasCaughtUpSubscriptions());
+  ASSERT_EQ(balance, sync2.getSubscription(m_accounts[1].address)->getContainer().balance(ITransfersContainer::IncludeAll));
+
+  std::vector<AccountPublicAddress> subscriptions;
+  sync2.getSubscriptions(subscriptions);
+  ASSERT_EQ(2, subscriptions.size());
+
+  generateMoneyForAccount(1);
+  generator.generateEmptyBlocks(10);
+
+  syncCompleted = std::promise<std::error_code>();
+  syncCompletedFuture = syncCompleted.get_future();
+  bsync2.addObserver(this);
+  bsync2.start();
+  syncCompletedFuture.get();
+  bsync2.removeObserver(this);
+  bsync2.stop();
+
+  ASSERT_TRUE(sync2.hasCaughtUpSubscriptions());
+  ASSERT_EQ(1, sync2.mergeCaughtUpSubscriptions());
+  ASSERT_FALSE(sync2.hasCatchUpSubscriptions());
+
+  auto sub = sync2.getSubscription(m_accounts[1].address);
+  ASSERT_NE(nullptr, sub);
+  ASSERT_LT(balance, sub->getContainer().balance(ITransfersContainer::IncludeAll));
+  ASSERT_EQ(0, sync2.getSubscription(m_accounts[0].address)->getContainer().transfersCount());
+}
+
+TEST_F(TransfersApi, loadsArchiveWithoutCatchUpConsumers) {
+  addMinerAccount();
+  subscribeAccounts();
+
+  generator.generateEmptyBlocks(20);
+
+  startSync();
+  m_sync.stop();
+
+  std::stringstream memstm;
+  m_transfersSync.save(memstm);
+
+  // version 0 archive: the genesis block hash, the version and the consumers without the catch up consumers array
+  std::string archive = memstm.str();
+  const size_t versionOffset = sizeof(Crypto::Hash);
+  ASSERT_EQ(1, archive[versionOffset]);
+  ASSERT_EQ(0, archive.back());
+  archive[versionOffset] = 0;
+  archive.pop_back();
+
+  BlockchainSynchronizer bsync2(m_node, m_logger, m_currency.genesisBlockHash());
+  TransfersSyncronizer sync2(m_currency, m_logger, bsync2, m_node);
+
+  for (size_t i = 0; i < m_accounts.size(); ++i) {
+    sync2.addSubscription(createSubscription(i));
+  }
+
+  std::stringstream archiveStream(archive);
+  sync2.load(archiveStream);
+
+  ASSERT_FALSE(sync2.hasCatchUpSubscriptions());
+  ASSERT_TRUE(compareStates(m_transfersSync, sync2));
+}
@@ -731,6 +731,44 @@ TEST_F(TransfersContainer_balance, handlesTransferStateUnLocked) {
   ASSERT_EQ(AMOUNT_2, container.balance(ITransfersContainer::IncludeStateUnlocked | ITransfersContainer::IncludeTypeAll));
 }
 
+TEST_F(TransfersContainer_balance, movesLockedByHeightTransferToUnlockedWhenHeightAdvances) {
+  uint64_t unlockTime = TEST_BLOCK_HEIGHT + 10;
+  TestTransactionBuilder tx1;
+  tx1.setUnlockTime(unlockTime);
+  tx1.addTestInput(AMOUNT_1 + 1);
+  auto outInfo = tx1.addTestKeyOutput(AMOUNT_1, TEST_TRANSACTION_OUTPUT_GLOBAL_INDEX, account);
+  ASSERT_TRUE(container.addTransaction(blockInfo(TEST_BLOCK_HEIGHT), *tx1.build(), { outInfo }));
+
+  uint32_t unlockHeight = static_cast<uint32_t>(unlockTime - currency.lockedTxAllowedDeltaBlocks());
+  ASSERT_TRUE(container.advanceHeight(unlockHeight - 1));
+  ASSERT_EQ(AMOUNT_1, container.balance(ITransfersContainer::IncludeStateLocked | ITransfersContainer::IncludeTypeAll));
+  ASSERT_EQ(0, container.balance(ITransfersContainer::IncludeStateUnlocked | ITransfersContainer::IncludeTypeAll));
+
+  ASSERT_TRUE(container.advanceHeight(unlockHeight));
+  ASSERT_EQ(0, container.balance(ITransfersContainer::IncludeStateLocked | ITransfersContainer::IncludeTypeAll));
+  ASSERT_EQ(AMOUNT_1, container.balance(ITransfersContainer::IncludeStateUnlocked | ITransfersContainer::IncludeTypeAll));
+}
+
+TEST_F(TransfersContainer_balance, restoresTransferStateAfterDetach) {
+  auto tx1 = addTransaction(TEST_BLOCK_HEIGHT, AMOUNT_1);
+  auto tx2 = addTransaction(TEST_CONTAINER_CURRENT_HEIGHT, AMOUNT_2);
+  ASSERT_EQ(AMOUNT_1, container.balance(ITransfersContainer::IncludeAllUnlocked));
+
+  container.detach(TEST_BLOCK_HEIGHT + 1);
+
+  ASSERT_EQ(0, container.balance(ITransfersContainer::IncludeAllUnlocked));
+  ASSERT_EQ(AMOUNT_1, container.balance(ITransfersContainer::IncludeStateSoftLocked | ITransfersContainer::IncludeTypeAll));
+}
+
+TEST_F(TransfersContainer_balance, spentTransferIsRemovedFromBalance) {
+  auto tx1 = addTransaction(TEST_BLOCK_HEIGHT, AMOUNT_1 + AMOUNT_2);
+  container.advanceHeight(TEST_CONTAINER_CURRENT_HEIGHT);
+  auto tx2 = addSpendingTransaction(tx1->getTransactionHash(), TEST_CONTAINER_CURRENT_HEIGHT, 0, AMOUNT_1);
+
+  ASSERT_EQ(0, container.balance(ITransfersContainer::IncludeAllUnlocked));
+  ASSERT_EQ(AMOUNT_2, container.balance(ITransfersContainer::IncludeAll));
+}
+
 //--------------------------------------------------------------------------- 
 // TransfersContainer_getOutputs
 //--------------------------------------------------------------------------- 
@@ -262,6 +262,11 @@ void WalletApi::cleanUpWalletFiles() const {
   if (boost::filesystem::exists(BOB_WALLET_BACKUP_PATH)) {
     boost::filesystem::remove(BOB_WALLET_BACKUP_PATH);
   }
+
+  for (const auto& path : { ALICE_WALLET_PATH, BOB_WALLET_PATH }) {
+    boost::system::error_code ignore;
+    boost::filesystem::remove(path + ".journal", ignore);
+  }
 }
 
 void WalletApi::setMinerTo(CryptoNote::WalletGreen& wallet) {
@@ -4272,6 +4277,122 @@ TEST_F(WalletApi, walletSavesAndLoadsExtra) {
   ASSERT_EQ(savedExtra, loadedExtra);
 }
 
+namespace {
+
+std::string readWalletFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void openWalletJournal(const std::string& path, WalletJournalStorage& journal) {
+  // the journal prefix holds its version and the IV of the cache it extends
+  const uint64_t journalPrefixSize = sizeof(uint8_t) + sizeof(Crypto::chacha8_iv);
+  journal.open(path + ".journal", Common::FileMappedVectorOpenMode::OPEN, journalPrefixSize);
+}
+
+uint64_t getWalletJournalSize(const std::string& path) {
+  WalletJournalStorage journal;
+  openWalletJournal(path, journal);
+  return journal.size();
+}
+
+}
+
+TEST_F(WalletApi, loadAppliesJournalSavedAfterCache) {
+  // The first save writes the whole cache, the next one appends a journal record
+  alice.save();
+  auto containerData = readWalletFile(ALICE_WALLET_PATH);
+  auto journalSize = boost::filesystem::file_size(ALICE_WALLET_PATH + ".journal");
+  auto cachedBlockCount = alice.getBlockCount();
+
+  generateAndUnlockMoney();
+  waitForWalletEvent(alice, CryptoNote::SYNC_COMPLETED, std::chrono::seconds(5));
+  alice.save(WalletSaveLevel::SAVE_ALL, "journal extra");
+
+  ASSERT_LT(journalSize, boost::filesystem::file_size(ALICE_WALLET_PATH + ".journal"));
+  ASSERT_EQ(containerData, readWalletFile(ALICE_WALLET_PATH));
+
+  ASSERT_NE(0, alice.getTransactionCount());
+  ASSERT_LT(cachedBlockCount, alice.getBlockCount());
+  auto aliceTransactions = exportWalletTransactions(alice);
+  auto actualBalance = alice.getActualBalance();
+  auto pendingBalance = alice.getPendingBalance();
+
+  alice.shutdown();
+
+  std::string loadedExtra;
+  alice.load(ALICE_WALLET_PATH, "pass", loadedExtra);
+
+  ASSERT_EQ("journal extra", loadedExtra);
+  ASSERT_LT(cachedBlockCount, alice.getBlockCount());
+  ASSERT_EQ(actualBalance, alice.getActualBalance());
+  ASSERT_EQ(pendingBalance, alice.getPendingBalance());
+  compareWalletsTransactionTransfers(aliceTransactions, alice, true);
+}
+
+TEST_F(WalletApi, loadDropsJournalRecordWithBadChecksum) {
+  generateAndUnlockMoney();
+  waitForWalletEvent(alice, CryptoNote::SYNC_COMPLETED, std::chrono::seconds(5));
+  alice.save();
+  alice.save(WalletSaveLevel::SAVE_ALL, "first record");
+
+  auto journalSize = getWalletJournalSize(ALICE_WALLET_PATH);
+  auto pendingBalance = alice.getPendingBalance();
+
+  generateBlockReward();
+  node.updateObservers();
+  waitPendingBalanceUpdated(pendingBalance);
+  alice.save(WalletSaveLevel::SAVE_ALL, "second record");
+  alice.shutdown();
+
+  {
+    WalletJournalStorage journal;
+    openWalletJournal(ALICE_WALLET_PATH, journal);
+    ASSERT_LT(journalSize, journal.size());
+    *std::prev(journal.end()) ^= 0x01;
+    journal.flush();
+  }
+
+  std::string loadedExtra;
+  alice.load(ALICE_WALLET_PATH, "pass", loadedExtra);
+
+  ASSERT_EQ("first record", loadedExtra);
+  ASSERT_EQ(pendingBalance, alice.getPendingBalance());
+  ASSERT_EQ(journalSize, getWalletJournalSize(ALICE_WALLET_PATH));
+}
+
+TEST_F(WalletApi, loadDropsTruncatedJournalRecord) {
+  generateAndUnlockMoney();
+  waitForWalletEvent(alice, CryptoNote::SYNC_COMPLETED, std::chrono::seconds(5));
+  alice.save();
+  alice.save(WalletSaveLevel::SAVE_ALL, "first record");
+
+  auto journalSize = getWalletJournalSize(ALICE_WALLET_PATH);
+  auto pendingBalance = alice.getPendingBalance();
+
+  generateBlockReward();
+  node.updateObservers();
+  waitPendingBalanceUpdated(pendingBalance);
+  alice.save(WalletSaveLevel::SAVE_ALL, "second record");
+  alice.shutdown();
+
+  {
+    // a crash in the middle of an append leaves a part of the record
+    WalletJournalStorage journal;
+    openWalletJournal(ALICE_WALLET_PATH, journal);
+    ASSERT_LT(journalSize + 1, journal.size());
+    journal.erase(std::prev(journal.end()), journal.end());
+    journal.flush();
+  }
+
+  std::string loadedExtra;
+  alice.load(ALICE_WALLET_PATH, "pass", loadedExtra);
+
+  ASSERT_EQ("first record", loadedExtra);
+  ASSERT_EQ(pendingBalance, alice.getPendingBalance());
+  ASSERT_EQ(journalSize, getWalletJournalSize(ALICE_WALLET_PATH));
+}
+
 TEST_F(WalletApi, walletHandlesResetAndSwitchingToAlternativeChain) {
   // Create transaction 1, that will be preserved
   generateBlockReward(aliceAddress);